@@ -0,0 +1,115 @@
+#ifndef _AIDA64_BINARY_H_
+#define _AIDA64_BINARY_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "public.h"
+#include "aida64_layout.h"
+#include "aida64_parser.h"
+
+/*
+ * 紧凑二进制协议
+ * 由Linux端的 aida64_companion (src/companion) 订阅AIDA64后转发, 代替逐字符解析的SSE文本.
+ *
+ * 帧 = 8字节头 + 负载 + 可选的CRC-16/CCITT (覆盖头和负载), 多字节字段均为小端
+ *   LAYOUT:   count, 每项 id, label, unit (长度前缀字符串) + numeric
+ *   KEYFRAME: count, 每项 index + 值, 包含全部项目
+ *   DELTA:    count, 每项 index + 值, 只包含变化的项目
+ * 数值项为 FIXED_DECIMALS 位小数的定点数, 以与上一帧之差的zigzag变长整数编码 (关键帧相对0);
+ * 文本项 (IP、时间) 为长度前缀字符串. 序号不连续时丢弃差分帧, 直到下一个关键帧.
+ * 序号只随数值帧递增; 单独补发的关键帧使用最近一个数值帧的序号, 之后的差分帧可以直接衔接
+ */
+
+#define binaryPrintLog(format, arg...) UARTPrintf("\r\n[BINARY] " format, ##arg)
+#define binaryDebugLog(format, arg...) UARTDebugf("\r\n[BINARY] " format, ##arg)
+
+#define AIDA64_BIN_MAGIC 0xA6
+#define AIDA64_BIN_VERSION 1
+#define AIDA64_BIN_HEADER_SIZE 8
+#define AIDA64_BIN_CRC_SIZE 2
+#define AIDA64_BIN_MAX_ITEMS 64
+// 单帧上限, 必须能放进 AIDA64_STREAM
+#define AIDA64_BIN_MAX_FRAME 2048
+
+// 伴随程序的默认端口
+#ifndef COMPANION_PORT
+#define COMPANION_PORT 8090
+#endif
+
+// 组播接收端在这段时间内没有收到数据时重新加入组 (中继默认每秒一帧)
+#ifndef COMPANION_MULTICAST_TIMEOUT_MS
+#define COMPANION_MULTICAST_TIMEOUT_MS 10000
+#endif
+
+enum AIDA64_BIN_TYPE {
+    AIDA64_BIN_LAYOUT = 1,
+    AIDA64_BIN_KEYFRAME = 2,
+    AIDA64_BIN_DELTA = 3,
+};
+
+#define AIDA64_BIN_FLAG_CRC 0x01
+
+typedef struct
+{
+    uint8_t type;
+    uint8_t flags;
+    uint16_t seq;
+    uint16_t length;        // 负载长度
+    const uint8_t *payload; // 指向流缓冲区, 下一次读取之前有效
+} AIDA64_BIN_FRAME;
+
+// 每个项目的最近值, 编码端和解码端各保存一份
+typedef struct
+{
+    uint8_t numeric;
+    uint8_t valid;          // 已收到过数值
+    int32_t value;
+    char text[32];          // 文本项, 与 AIDA64_DATA.val 等长
+} AIDA64_BIN_ITEM;
+
+typedef struct
+{
+    std::vector<AIDA64_BIN_ITEM> items;
+    std::vector<AIDA64_DATA> frame;     // 按布局顺序的完整帧, 只更新变化的项目
+    uint16_t layout_crc;    // 当前布局帧负载的CRC, 相同的布局 (组播定期重发) 不再重建
+    uint16_t seq;
+    bool synced;            // 已收到布局和关键帧, 差分帧可用
+} AIDA64_BIN_DECODER;
+
+typedef struct
+{
+    std::vector<AIDA64_LAYOUT_ITEM> layout;
+    std::vector<AIDA64_BIN_ITEM> items;
+    uint16_t seq;           // 最近一个数值帧的序号
+    uint32_t frames;        // 上一个关键帧之后的帧数
+    uint32_t keyframe_interval;
+    bool crc;
+} AIDA64_BIN_ENCODER;
+
+extern uint16_t aida64BinaryCrc(const uint8_t *data, size_t len);
+
+// 从流缓冲区取出下一个完整的帧 (不复制), 没有时返回false并把不完整的帧移到缓冲区开头
+extern bool aida64BinaryNextFrame(AIDA64_STREAM &stream, AIDA64_BIN_FRAME &frame);
+
+extern void aida64BinaryDecoderReset(AIDA64_BIN_DECODER &decoder);
+// 布局帧与当前布局不同, 解码时会重建项目表
+extern bool aida64BinaryLayoutChanged(const AIDA64_BIN_DECODER &decoder, const AIDA64_BIN_FRAME &frame);
+// 布局未变化时不改变解码状态并返回false
+extern bool aida64BinaryDecodeLayout(AIDA64_BIN_DECODER &decoder, const AIDA64_BIN_FRAME &frame,
+                                     std::vector<AIDA64_LAYOUT_ITEM> &layout);
+// 解码数值帧, 成功时dataList为与SSE解析结果相同格式的完整帧
+extern bool aida64BinaryDecodeData(AIDA64_BIN_DECODER &decoder, const AIDA64_BIN_FRAME &frame,
+                                   std::vector<AIDA64_DATA> &dataList);
+
+extern void aida64BinaryEncoderInit(AIDA64_BIN_ENCODER &encoder, const std::vector<AIDA64_LAYOUT_ITEM> &layout,
+                                    uint32_t keyframe_interval, bool crc);
+// 编码布局帧, 不改变编码状态, 可以单独发给新连接的接收端; 返回帧长度, 空间不足时返回0
+extern size_t aida64BinaryEncodeLayout(const AIDA64_BIN_ENCODER &encoder, uint8_t *out, size_t size);
+// 按当前状态单独编码一个关键帧 (新连接或丢帧后的接收端), 不影响共享的数值帧序列
+extern size_t aida64BinaryEncodeKeyframe(const AIDA64_BIN_ENCODER &encoder, uint8_t *out, size_t size);
+// 编码一个SSE数据帧, 没有变化的差分帧也会输出 (作为心跳)
+extern size_t aida64BinaryEncodeData(AIDA64_BIN_ENCODER &encoder, const std::vector<AIDA64_DATA> &dataList,
+                                     uint8_t *out, size_t size);
+
+#endif
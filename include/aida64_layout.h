@@ -0,0 +1,37 @@
+#ifndef _AIDA64_LAYOUT_H_
+#define _AIDA64_LAYOUT_H_
+
+#include <stdint.h>
+#include <vector>
+#include "public.h"
+
+#define layoutPrintLog(format, arg...) UARTPrintf("\r\n[LAYOUT] " format, ##arg)
+
+// 从AIDA64 HTML页面中发现的布局项
+typedef struct
+{
+    char id[32];
+    char label[32];     // 数值前的标签文本, 例如 "CPU Usage"
+    char prefix[32];    // 去除空格后的标签, 用于在SSE数据中直接跳到数值
+    char unit[16];      // 数值后的单位文本, 例如 "%", "MHz"
+    uint8_t numeric;    // 1: 单个数值; 0: IP、时间等文本
+}AIDA64_LAYOUT_ITEM;
+
+// 将 "CPU Usage 3%" 这类文本拆分为标签、数值、单位
+extern void splitAida64Text(const char *text, AIDA64_LAYOUT_ITEM &item);
+
+// 在值字符串中定位数值部分, prefix可为空 (此时从尾部反向查找)
+extern const char *findAida64Value(const char *text, const char *prefix);
+
+// 布局哈希 (FNV-1a), 只覆盖id、标签和单位
+extern uint32_t calcAida64LayoutHash(const std::vector<AIDA64_LAYOUT_ITEM> &layout);
+
+// HTTP任务发布新布局, 显示侧按哈希判断是否需要重建
+extern void publishAida64Layout(const std::vector<AIDA64_LAYOUT_ITEM> &layout);
+extern uint32_t getAida64LayoutHash();
+extern uint32_t copyAida64Layout(std::vector<AIDA64_LAYOUT_ITEM> &layout);
+
+// 未发现布局前使用的默认布局 (对应 aida64config/eng.rslcd)
+extern void getDefaultAida64Layout(std::vector<AIDA64_LAYOUT_ITEM> &layout);
+
+#endif
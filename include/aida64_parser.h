@@ -0,0 +1,35 @@
+#ifndef _AIDA64_PARSER_H_
+#define _AIDA64_PARSER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+#include "public.h"
+#include "aida64_layout.h"
+
+#define parserPrintLog(format, arg...) UARTPrintf("\r\n[PARSER] " format, ##arg)
+#define parserDebugLog(format, arg...) UARTDebugf("\r\n[PARSER] " format, ##arg)
+
+#define AIDA64_STREAM_SIZE 4096
+
+// SSE帧组装缓冲区: 一个事件可能跨多次recv, 按完整的 "data:" 行取出
+typedef struct
+{
+    char buffer[AIDA64_STREAM_SIZE];
+    size_t length;      // 缓冲区中的数据长度
+    size_t scan;        // 已取出的行之后的位置
+} AIDA64_STREAM;
+
+extern void aida64StreamReset(AIDA64_STREAM &stream);
+// 可写入的位置和空间 (保留结尾的 '\0')
+extern char *aida64StreamWritePtr(AIDA64_STREAM &stream, size_t *space);
+extern void aida64StreamCommit(AIDA64_STREAM &stream, size_t len);
+// 取出下一个完整的 "data:" 行, 没有时返回NULL并把不完整的行移到缓冲区开头
+extern char *aida64StreamNextEvent(AIDA64_STREAM &stream);
+
+extern void parseAida64HTML(const char *htmlData, std::vector<AIDA64_DATA> &dataList);
+// 从AIDA64页面生成布局, 页面中没有LCD项目时layout为空
+extern void parseAida64Layout(const char *htmlData, std::vector<AIDA64_LAYOUT_ITEM> &layout);
+extern void parseAida64Data(char *src, std::vector<AIDA64_DATA> &dataList);
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef _ALLOC_TRACK_H_
+#define _ALLOC_TRACK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+#include "public.h"
+#include "metrics.h"
+
+/*
+ * 堆分配统计
+ * 链接时用 -Wl,--wrap 截获 malloc/calloc/realloc (operator new 也经过malloc) 和LVGL内存池的 lv_mem_alloc/lv_mem_realloc,
+ * 按当前任务所处的管线阶段计数;
+ * 预热若干帧后进入稳态检查, 之后管线阶段内的任何堆分配都计为违规.
+ * 使用 env:esp32dev_alloc / env:native_alloc 构建, 见 platformio.ini
+ */
+
+#define allocPrintLog(format, arg...) UARTPrintf("\r\n[ALLOC] " format, ##arg)
+
+// 编译期开关, 关闭后阶段标记不参与编译
+#ifndef ALLOC_TRACK
+#define ALLOC_TRACK 0
+#endif
+
+// 预热帧数: 容器容量、LVGL缓存和互斥锁等在前几帧内完成首次分配
+#ifndef ALLOC_WARMUP_FRAMES
+#define ALLOC_WARMUP_FRAMES 10
+#endif
+
+// 1: 稳态违规时立即abort, 由崩溃回溯定位分配点
+#ifndef ALLOC_TRACK_STRICT
+#define ALLOC_TRACK_STRICT 0
+#endif
+
+// 参与稳态检查的阶段 (按PIPELINE_STAGE的位), 默认不含recv: lwIP在调用方任务中为消息分配内存, 只计数不检查
+#ifndef ALLOC_STRICT_STAGES
+#define ALLOC_STRICT_STAGES ((1u << STAGE_MAX) - 1 - (1u << STAGE_RECV))
+#endif
+
+#if ALLOC_TRACK
+extern void allocTrackBegin();
+
+// 设置当前任务所处的阶段, 返回之前的阶段 (STAGE_MAX表示不在管线中)
+extern PIPELINE_STAGE allocSetStage(PIPELINE_STAGE stage);
+
+// 每分发一帧调用一次, 达到预热帧数后开始稳态检查
+extern void allocOnFrame();
+// 布局重建等预期内的分配之前调用, 重新预热
+extern void allocRestartWarmup();
+extern bool allocIsSteady();
+
+// 累计分配次数 / 稳态后的分配次数, stage为STAGE_MAX时返回管线之外的分配
+extern uint32_t allocGetCount(PIPELINE_STAGE stage);
+extern uint32_t allocGetSteadyCount(PIPELINE_STAGE stage);
+// 累计次数中来自LVGL内存池的部分
+extern uint32_t allocGetLvglCount(PIPELINE_STAGE stage);
+// 参与检查的阶段中稳态后的分配总数
+extern uint32_t allocGetViolations();
+extern uint32_t allocGetFailed();
+
+// 在管线之外调用 (loop), 输出新出现的违规和分配失败
+extern void allocCheck();
+
+// 作用域阶段标记: 构造时进入阶段, 析构时恢复之前的阶段
+class AllocStageScope {
+public:
+    explicit AllocStageScope(PIPELINE_STAGE stage) : prev(allocSetStage(stage)) {}
+    ~AllocStageScope() { allocSetStage(prev); }
+
+private:
+    PIPELINE_STAGE prev;
+};
+
+#define ALLOC_CONCAT_(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_(a, b)
+#define ALLOC_STAGE(stage) AllocStageScope ALLOC_CONCAT(_alloc_scope_, __LINE__)(stage)
+#else
+#define ALLOC_STAGE(stage) do {} while (0)
+static inline void allocTrackBegin() {}
+static inline void allocOnFrame() {}
+static inline void allocRestartWarmup() {}
+static inline void allocCheck() {}
+#endif
+
+#endif
@@ -11,6 +11,12 @@
 #define MAX_Y 240
 #define MAX_X 320
 
+// 触摸校准 (XPT2046原始值), 不定义时使用默认值
+// #define TOUCH_X_MIN 200
+// #define TOUCH_X_MAX 3700
+// #define TOUCH_Y_MIN 240
+// #define TOUCH_Y_MAX 3800
+
 //WIFI
 #define WIFI_SSID "10086"
 #define WIFI_PASS "aaaaa123456"
@@ -19,15 +25,49 @@
 #define HTTP_HOST "192.168.1.1"
 #define HTTP_PORT 80
 
+//二进制协议 (可选): 定义后连接Linux上的 aida64_companion, 不再直接访问AIDA64 (见 src/companion)
+// #define COMPANION_HOST "192.168.1.2"
+// #define COMPANION_PORT 8090
+//或者接收中继 (-m) 的UDP组播, 端口同 COMPANION_PORT; 优先于 COMPANION_HOST
+// #define COMPANION_MULTICAST "239.255.64.64"
+// #define COMPANION_MULTICAST_TIMEOUT_MS 10000
+
 //NTP时间同步配置
 #define NTP_SERVER_1 "pool.ntp.org"
 #define NTP_SERVER_2 "time.nist.gov" 
 #define NTP_SERVER_3 "cn.pool.ntp.org"
 #define TIMEZONE_OFFSET_SECONDS (8 * 3600)  // 中国时区 UTC+8
 #define NTP_UPDATE_INTERVAL (60 * 60 * 1000) // 每小时同步一次 (毫秒)
+// #define NTP_SYNC_TIMEOUT (15 * 1000)        // 等待SNTP应答的超时, 超时后重新请求 (毫秒, 可选)
+
+//Prometheus指标端口 (可选, 默认9100), 访问 http://<设备IP>:9100/metrics
+// #define METRICS_PORT 9100
+
+//性能浮层 (可选), 1: 开机即显示; 运行时长按屏幕切换
+// #define PERF_HUD_DEFAULT 0
+
+//电源管理 (可选, 不定义时使用默认值)
+// #define POWER_DIM_TIMEOUT (30 * 1000)       // 多久没有新数据后调暗背光 (毫秒)
+// #define POWER_IDLE_TIMEOUT (5 * 60 * 1000)  // 多久没有新数据后关闭背光并暂停渲染 (毫秒)
+// #define BACKLIGHT_DIM_LEVEL 40              // 调暗时的背光亮度 (0-255)
+// #define CPU_IDLE_MHZ 80                     // 空闲时的CPU频率
+
+//WiFi省电策略 (可选): 有数据流时关闭省电, 数据中断后进入modem sleep, 慢速数据流定期试探modem sleep
+// #define WIFI_PS_IDLE_TIMEOUT (30 * 1000)        // 多久没有数据后进入modem sleep (毫秒, 默认同POWER_DIM_TIMEOUT)
+// #define WIFI_PS_JITTER_BUDGET 30                // 试探时允许的到达间隔抖动p90 (相对间隔中位数, 毫秒)
+// #define WIFI_PS_PROBE_INTERVAL (10 * 60 * 1000) // 试探间隔 (毫秒)
+
+//堆分配检查 (可选, 由 env:esp32dev_alloc / env:native_alloc 定义 ALLOC_TRACK=1)
+// #define ALLOC_WARMUP_FRAMES 10                  // 预热帧数, 之后管线阶段中的堆分配计为违规
+// #define ALLOC_TRACK_STRICT 1                    // 违规时立即abort
+
+//更新等级 (可选): 利用率等每帧处理, 频率/功耗/温度等慢速, IP/显存极慢, 间隔内到达的数值直接跳过
+// #define UPDATE_RATE_SLOW_INTERVAL 2000             // 慢速项目的最短处理间隔 (毫秒)
+// #define UPDATE_RATE_VERY_SLOW_INTERVAL (60 * 1000) // 极慢项目的最短处理间隔 (毫秒)
+// #define UPDATE_RATE_OVERRIDES {"Simple13", RATE_VERY_SLOW}, {"Simple5", RATE_FAST},  // 按id指定等级
 
-//显示更新间隔
-#define DATA_UPDATE_INTERVAL 1000  // AIDA64数据更新间隔 (毫秒)
-#define TIME_UPDATE_INTERVAL 1000  // 时间显示更新间隔 (毫秒)
+//热启动快照 (可选): 开机时先以灰色显示上次的数据
+// #define WARM_CACHE_RTC_PERIOD (5 * 1000)        // RTC内存快照的最短写入间隔 (毫秒)
+// #define WARM_CACHE_NVS_PERIOD (15 * 60 * 1000)  // NVS快照的最短写入间隔 (毫秒), 限制flash写入
 
 #endif
\ No newline at end of file
@@ -1,12 +1,17 @@
 #ifndef _DISPLAY_H_
 #define _DISPLAY_H_
 
-#include <TFT_eSPI.h>
 #include <lvgl.h>
+#include "config.h"
 #include "public.h"
+#include "aida64_layout.h"
+#include "frame_pacer.h"
+#include "power_manager.h"
+#include "hal.h"
 #include <vector>
 
 #define displayPrintLog(format, arg...) UARTPrintf("\r\n[DISPLAY] " format, ##arg)
+#define displayDebugLog(format, arg...) UARTDebugf("\r\n[DISPLAY] " format, ##arg)
 
 // 屏幕方向枚举
 enum SCREEN_DIRECTION {
@@ -25,13 +30,61 @@ enum AIDA64_CATEGORY {
     AIDA64_OTHER
 };
 
-// 数据项结构
-struct AIDA64_ITEM {
+// 页面, 详情页按数据类别筛选绑定项
+enum DISPLAY_PAGE {
+    PAGE_OVERVIEW,
+    PAGE_CPU,
+    PAGE_GPU,
+    PAGE_MEMORY,
+    PAGE_NETWORK,
+    PAGE_MAX,
+};
+
+// 数据项显示类型
+enum AIDA64_WIDGET_KIND {
+    AIDA64_WIDGET_BAR,      // 百分比: 标题 + 数值 + 进度条
+    AIDA64_WIDGET_VALUE,    // 数值: "标题: 数值 单位"
+    AIDA64_WIDGET_TEXT,     // 文本: IP、时间等原样显示
+};
+
+// 更新等级: 决定绑定项的最短处理间隔, 间隔内到达的数值直接丢弃 (下一帧会带来最新值)
+enum AIDA64_RATE_CLASS {
+    RATE_FAST,              // 利用率、吞吐量、时间: 每帧处理
+    RATE_SLOW,              // 频率、功耗、温度等
+    RATE_VERY_SLOW,         // IP、显存等几乎不变的项目
+    RATE_CLASS_MAX,
+};
+
+// 各等级的最短处理间隔 (毫秒)
+#ifndef UPDATE_RATE_FAST_INTERVAL
+#define UPDATE_RATE_FAST_INTERVAL 0
+#endif
+#ifndef UPDATE_RATE_SLOW_INTERVAL
+#define UPDATE_RATE_SLOW_INTERVAL 2000
+#endif
+#ifndef UPDATE_RATE_VERY_SLOW_INTERVAL
+#define UPDATE_RATE_VERY_SLOW_INTERVAL (60 * 1000)
+#endif
+
+// 运行时绑定表项, 由布局发现生成, 数据更新时按表查找
+struct AIDA64_BINDING {
+    char id[32];
+    char prefix[32];        // SSE值中数值前的标签 (已去空格)
+    char caption[16];       // 屏幕上显示的标题 (仅ASCII)
+    char unit[16];
     AIDA64_CATEGORY category;
-    const char* label;
-    const char* value;
-    const char* unit;
-    lv_color_t color;
+    AIDA64_WIDGET_KIND kind;
+    AIDA64_RATE_CLASS rate;
+    uint32_t next_update_ms;    // 在此之前到达的数值跳过解析和控件更新
+    char text[32];          // 最近一次格式化后的数值, 数值标签通过lv_label_set_text_static直接引用
+    int32_t bar_value;
+    int32_t bar_shown;      // 进度条当前显示的值, 过渡期间由tick()逐帧推进到bar_value
+    int32_t bar_from;
+    uint32_t bar_start_ms;
+    bool has_value;
+    bool stale;             // 来自热启动快照, 尚未收到实时数据, 以灰色显示
+    lv_obj_t* value_label;  // 仅当所在页面可见时非空
+    lv_obj_t* bar;
 };
 
 class SCREEN_DISPLAY_ENHANCED {
@@ -41,18 +94,31 @@ public:
 
     void begin(int dir);
     void setScreenDir(int dir);
-    void displayAida64Data(std::vector<AIDA64_DATA> &dataList);
-    void updateTimeDisplay(const String& timeString);
+    void displayAida64Data(std::vector<AIDA64_DATA> &dataList, uint32_t arrival_us = 0);
+    // 时钟: seconds_of_day为本地时间的当日秒数, 未同步时为-1
+    void updateClock(int32_t seconds_of_day);
     void clear();
     void updateDisplay();
-    void tick();
+    uint32_t tick();
 
     void setPowerSave(uint8_t is_enable) {
-        // TFT displays don't have power save mode like VFD
+        // 由电源状态机在loop()中执行, 这里只提交请求
+        powerManager.requestSleep(is_enable != 0);
     }
 
+    // 背光PWM亮度 (0-255)
+    void setBacklight(uint8_t level);
+
+    // 暂停/恢复LVGL渲染, 暂停期间的控件变化在恢复后的第一帧绘制
+    void setRenderingPaused(bool paused) { pacer.setPaused(paused); }
+    RENDER_QUALITY getRenderQuality() const { return pacer.getQuality(); }
+    // 进度条过渡是否仍在进行 (不经过LVGL动画, lv_anim_count_running不包含)
+    bool barsAnimating() const { return bars_animating; }
+
+    // 性能浮层: 各管线阶段的min/avg/max, 长按屏幕切换
+    void setPerfHud(bool visible);
+
 private:
-    TFT_eSPI tft;
     int screen_dir;
     
     // LVGL 相关
@@ -61,42 +127,69 @@ private:
     lv_disp_draw_buf_t draw_buf;
     lv_color_t* buf1;
     lv_color_t* buf2;
+    FramePacer pacer;
+    uint32_t frame_flush_us;    // 当前帧累计的刷新耗时
+    uint32_t frame_flush_px;
+    
+    // 触摸输入
+    lv_indev_drv_t indev_drv;
+    lv_indev_t* indev;
     
     // UI 对象
     lv_obj_t* main_screen;
     lv_obj_t* title_label;
     
     // 系统信息对象
-    lv_obj_t* time_label;
-    lv_obj_t* cpu_bar;
-    lv_obj_t* cpu_label;
-    lv_obj_t* gpu_bar;
-    lv_obj_t* gpu_label;
-    lv_obj_t* mem_bar;
-    lv_obj_t* mem_label;
+    // 时钟: 标题、时/分/秒三个两位数字段和两个分隔符, 只重绘数值变化的字段
+    lv_obj_t* clock_fields[3];
+    lv_obj_t* clock_parts[6];
+    int8_t clock_values[3];     // 当前显示的数值, -1表示 "--"
+    int8_t clock_synced;        // 当前颜色对应的同步状态, -1表示尚未设置
+    int32_t clock_seconds;
+    
+    // 分页: 只有当前页面的对象存在, 切换时释放旧页面
+    int current_page;
+    int pending_page;
+    
+    // 运行时绑定表
+    std::vector<AIDA64_BINDING> bindings;
+    uint32_t layout_hash;
+    size_t binding_hint;
     
-    // 额外的信息标签
-    lv_obj_t* temp_label;
-    lv_obj_t* gpu_temp_label;
-    lv_obj_t* mem_usage_label;
-    lv_obj_t* cpu_freq_label;
-    lv_obj_t* cpu_power_label;
-    lv_obj_t* gpu_power_label;
-    lv_obj_t* gpu_mem_label;
-    lv_obj_t* net_down_label;
-    lv_obj_t* net_up_label;
-    lv_obj_t* local_ip_label;
-    lv_obj_t* external_ip_label;
+    // 性能浮层 (位于顶层, 不随页面切换重建)
+    lv_obj_t* hud_label;
+    char hud_text[288];         // 浮层标签直接引用, 不在LVGL内存池中分配
+    bool hud_visible;
+    uint32_t hud_updated;
+    uint32_t pool_sampled;
+    bool bars_animating;
     
     // 私有方法
     void initLVGL();
+    void initTouch();
     void createUI();
-    void setupSingleScreenLayout();
-    void updateSystemInfo(std::vector<AIDA64_DATA> &dataList);
+    void showPage(int page);
+    void setupPageLayout(int page);
+    bool pageContains(int page, const AIDA64_BINDING &binding);
+    int nextPage(int step);
+    void buildBindings(const std::vector<AIDA64_LAYOUT_ITEM> &layout);
+    void syncLayout();
+    int findBinding(const char* id);
+    bool applyBinding(AIDA64_BINDING &binding, const char* value_str);
+    void renderBinding(AIDA64_BINDING &binding);
+    void paintBinding(AIDA64_BINDING &binding);
+    void stepBars();
+    void applySnapshot(std::vector<AIDA64_DATA> &snapshot);
+    bool updateSystemInfo(std::vector<AIDA64_DATA> &dataList);
+    void samplePool();
+    void updatePerfHud();
     
     // LVGL 回调函数
+    template <HAL_FLUSH_FN FLUSH>
     static void disp_flush(lv_disp_drv_t* disp, const lv_area_t* area, lv_color_t* color_p);
-    static void disp_flush_ready(lv_disp_drv_t* disp_drv);
+    static void refr_timer_cb(lv_timer_t* timer);
+    static void touch_read(lv_indev_drv_t* indev_drv, lv_indev_data_t* data);
+    static void screen_event_cb(lv_event_t* e);
 };
 
 extern SCREEN_DISPLAY_ENHANCED display_enhanced;
@@ -0,0 +1,28 @@
+#ifndef _FIXED_FORMAT_H_
+#define _FIXED_FORMAT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * 定点数解析与格式化
+ * 数值以缩放后的整数表示, 例如 decimals=2 时 12.34 表示为 1234,
+ * 全程不使用float和snprintf, 栈占用只有几十字节
+ */
+
+// 数值定点解析时保留的小数位数
+#define FIXED_DECIMALS 2
+
+// 解析十进制数, 多余的小数位向零截断 (由格式化时统一舍入); 没有数字时返回NULL, 否则返回数字之后的位置
+extern const char *parseFixed(const char *str, uint8_t decimals, int32_t *value);
+
+// 将 decimals_in 位小数的定点数按 decimals_out 位小数输出, 返回写入长度
+extern size_t formatFixed(char *buf, size_t size, int32_t value, uint8_t decimals_in, uint8_t decimals_out);
+
+// 按单位格式化, 大数值自动换算 (MB->GB, MHz->GHz, KB/s->MB/s)
+extern size_t formatFixedUnit(char *buf, size_t size, int32_t value, uint8_t decimals, const char *unit);
+
+// 定点数取整 (向零截断), 用于进度条
+extern int32_t fixedToInt(int32_t value, uint8_t decimals);
+
+#endif
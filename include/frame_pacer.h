@@ -0,0 +1,79 @@
+#ifndef _FRAME_PACER_H_
+#define _FRAME_PACER_H_
+
+#include <stdint.h>
+#include <lvgl.h>
+#include "public.h"
+
+#define pacerPrintLog(format, arg...) UARTPrintf("\r\n[PACER] " format, ##arg)
+
+// 渲染质量等级, 数值越大越省资源
+enum RENDER_QUALITY {
+    QUALITY_FULL,           // 进度条动画 + 全帧率
+    QUALITY_NO_ANIM,        // 关闭进度条动画
+    QUALITY_REDUCED_RATE,   // 关闭动画 + 降低刷新率
+    QUALITY_MINIMUM,        // 关闭动画 + 最低刷新率
+    QUALITY_MAX,
+};
+
+/*
+ * 帧节拍器
+ * 控件更新只标记脏区域, 由LVGL刷新定时器在每个帧槽内合并为一次渲染;
+ * 调节器根据渲染耗时和LVGL负载逐级降低/恢复渲染质量
+ */
+class FramePacer {
+public:
+    FramePacer();
+
+    void attach(lv_disp_t* disp);
+
+    // 标记有控件发生变化
+    void markDirty() { pending_updates++; }
+
+    // 新数据已应用到控件: 记录到达时间, 帧槽已空闲时立即安排渲染
+    void requestFrame(uint32_t arrival_us);
+
+    // 一帧的最后一块刷新到屏幕后调用, 统计数据到达->刷新完成的延迟
+    void onFlushComplete();
+
+    uint32_t lastLatencyUs() const { return latency_last_us; }
+
+    // 暂停/恢复刷新定时器
+    void setPaused(bool paused);
+
+    // 驱动LVGL定时器, 返回距离下一次需要处理的毫秒数
+    uint32_t service();
+
+    // LVGL每完成一帧渲染时调用, render_us包含绘制和刷新
+    void onFrameRendered(uint32_t render_us, uint32_t pixels);
+
+    bool animationsEnabled() const { return quality == QUALITY_FULL; }
+    uint32_t framePeriod() const;
+    RENDER_QUALITY getQuality() const { return quality; }
+
+private:
+    lv_disp_t* disp;
+    RENDER_QUALITY quality;
+
+    // 统计窗口
+    unsigned long window_start;
+    uint32_t frame_avg_us;      // 渲染耗时的指数滑动平均
+    uint32_t frames;
+    uint32_t pixels;
+    uint32_t pending_updates;
+    uint8_t pressure_windows;
+    uint8_t headroom_windows;
+    unsigned long last_frame_ms;
+
+    // 延迟计数器
+    uint32_t pending_arrival_us;
+    uint32_t latency_last_us;
+    uint32_t latency_max_us;
+    uint32_t latency_sum_us;
+    uint32_t latency_count;
+
+    void evaluate();
+    void setQuality(RENDER_QUALITY level);
+};
+
+#endif
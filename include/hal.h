@@ -0,0 +1,55 @@
+#ifndef _HAL_H_
+#define _HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/*
+ * 硬件抽象层
+ * 数据管线 (解析 -> 绑定 -> LVGL渲染 -> 刷新) 只通过这些接口访问时钟、日志输出、套接字和屏幕,
+ * ESP32实现见 src/hal/hal_esp32.cpp, Linux实现见 src/hal/hal_native.cpp (env:native)
+ * 同时被LVGL的C代码引用 (LV_TICK_CUSTOM), 因此使用C链接
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 时钟
+extern uint32_t halMillis(void);
+extern uint32_t halMicros(void);
+extern void halSetCpuMhz(uint32_t mhz);
+extern uint32_t halFreeHeap(void);
+
+// 日志输出, 阻塞写; ESP32上只由日志任务调用, native上由写日志的调用方同步调用
+extern void halLogWrite(const char *data, size_t len);
+
+// 套接字: ESP32上为lwIP recv, Linux上为read (也可以读取文件或管道)
+extern int halRecv(int fd, void *buf, size_t len);
+
+// 屏幕
+extern void halDisplayInit(void);
+extern void halDisplayRotate(int rotation);     // 0: 竖屏, 1: 横屏
+// 刷新一块区域, 每种像素字节序一个入口, 由调用方在编译期选定 (display.cpp 的 disp_flush)
+typedef void (*HAL_FLUSH_FN)(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint16_t *pixels);
+extern void halDisplayFlushPreswapped(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint16_t *pixels);  // 面板字节序 (大端)
+extern void halDisplayFlushSwap(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint16_t *pixels);        // 主机字节序, 刷新时交换
+extern void halBacklight(uint8_t level);
+extern bool halTouchRead(int16_t *x, int16_t *y);
+
+#ifndef ARDUINO
+// Linux: 内存帧缓冲区, 像素为面板字节序的RGB565
+extern const uint16_t *halFramebuffer(uint32_t *width, uint32_t *height);
+
+// Linux: 虚拟时钟, 须在halDisplayInit之前启用. 启用后halMillis只随halAdvanceMillis前进,
+// 调度、抽取和动画与运行速度无关; halMicros仍为真实时间, 只用于测量耗时
+extern void halUseVirtualClock(void);
+extern void halAdvanceMillis(uint32_t ms);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
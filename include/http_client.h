@@ -3,13 +3,17 @@
 #include <WiFi.h>
 #include <HTTPClient.h>
 #include "public.h"
+#include "aida64_layout.h"
+#include "aida64_parser.h"
 
 #define httpPrintLog(format, arg...) UARTPrintf("\r\n[HTTP] " format, ##arg)
+#define httpDebugLog(format, arg...) UARTDebugf("\r\n[HTTP] " format, ##arg)
 
 extern std::vector<AIDA64_DATA> aida64DataList;
 
 extern void taskHttpClient(void *param);
-extern void parseAida64HTML(char *htmlData, std::vector<AIDA64_DATA> &dataList);
-extern void parseAida64Data(char *src, std::vector<AIDA64_DATA> &dataList);
-extern void strremove(char* src, char remove);
+extern void setAida64FrameListener(TaskHandle_t task);
+extern void publishAida64Frame(const std::vector<AIDA64_DATA> &dataList, uint32_t arrivalUs);
+extern bool takeAida64Frame(std::vector<AIDA64_DATA> &dataList, uint32_t *arrivalUs);
+extern bool discoverAida64Layout();
 #endif
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef _LOG_H_
+#define _LOG_H_
+
+#include <stdint.h>
+
+/*
+ * 异步日志
+ * 调用方只把格式化后的一行写入环形缓冲区, 由低优先级任务输出到串口,
+ * 热路径不再等待115200波特率的UART发送
+ */
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+// 编译期日志等级, 高于此等级的调用连同参数求值一起被编译掉 (在platformio.ini中用 -DLOG_LEVEL=4 打开调试日志)
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// 每个调用点每秒最多输出的行数, 超出的行只计数
+#ifndef LOG_RATE_LIMIT
+#define LOG_RATE_LIMIT 10
+#endif
+
+// 环形缓冲区: 槽数 (2的幂) 和每行最大长度
+#ifndef LOG_RING_SLOTS
+#define LOG_RING_SLOTS 32
+#endif
+#define LOG_LINE_SIZE 128
+
+// 调用点限流状态, 每个调用点一个静态实例
+typedef struct
+{
+    uint32_t window_start;
+    uint16_t count;
+    uint16_t suppressed;
+} LOG_LIMIT;
+
+extern bool logAllow(LOG_LIMIT *limit);
+extern void logWrite(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+// 启动输出任务, 在Serial.begin之后调用; 任务启动前的日志暂存在缓冲区
+extern void logBegin();
+
+#define LOG_AT(level, format, arg...) do {          \
+    if ((level) <= LOG_LEVEL) {                     \
+        static LOG_LIMIT _log_limit;                \
+        if (logAllow(&_log_limit)) {                \
+            logWrite(format, ##arg);                \
+        }                                           \
+    }                                               \
+} while (0)
+
+#endif
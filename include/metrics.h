@@ -0,0 +1,92 @@
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include <stdint.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include "config.h"
+#include "public.h"
+
+#define metricsPrintLog(format, arg...) UARTPrintf("\r\n[METRICS] " format, ##arg)
+
+#ifndef METRICS_PORT
+#define METRICS_PORT 9100
+#endif
+
+// 计数器 (单调递增, 32位回绕时Prometheus按计数器重置处理)
+enum METRIC_COUNTER {
+    METRIC_FRAMES_RECEIVED,     // 收到并解析的数据帧
+    METRIC_FRAMES_DROPPED,      // 显示任务取走前被新帧覆盖的数据帧
+    METRIC_FLUSH_AREAS,         // disp_flush调用次数
+    METRIC_FLUSH_PIXELS,        // 推送到屏幕的像素数
+    METRIC_WIFI_RECONNECTS,
+    METRIC_SSE_RECONNECTS,
+    METRIC_LOG_DROPPED,         // 日志缓冲区满时丢弃的行
+    METRIC_LOG_SUPPRESSED,      // 被调用点限流丢弃的行
+    METRIC_BINDINGS_APPLIED,    // 按绑定表处理的数值
+    METRIC_BINDINGS_DECIMATED,  // 未到更新间隔而跳过的数值
+    METRIC_WIDGET_UPDATES,      // 数值变化后实际更新的控件
+    METRIC_COUNTER_MAX,
+};
+
+// 直方图 (单位微秒, 输出时换算为秒)
+enum METRIC_HISTOGRAM {
+    METRIC_PARSE_US,            // parseAida64Data耗时
+    METRIC_RENDER_US,           // LVGL一帧渲染耗时
+    METRIC_LATENCY_US,          // 数据到达 -> 刷新完成
+    METRIC_HISTOGRAM_MAX,
+};
+
+// 数据管线各阶段, 用于屏幕性能浮层的窗口统计
+enum PIPELINE_STAGE {
+    STAGE_RECV,                 // recv()调用 (含等待数据)
+    STAGE_ASSEMBLY,             // 拼接并切分出完整的data行
+    STAGE_PARSE,                // parseAida64Data
+    STAGE_DISPATCH,             // 显示任务按绑定表更新控件
+    STAGE_RENDER,               // LVGL绘制 (不含刷新)
+    STAGE_FLUSH,                // SPI推送到屏幕
+    STAGE_MAX,
+};
+
+// LVGL内存池快照; lv_mem_monitor不是线程安全的, 由显示任务定期采样, /metrics 只读取缓存值
+typedef struct
+{
+    uint32_t free_bytes;
+    uint32_t largest_free_bytes;
+    uint8_t frag_pct;
+} POOL_SNAPSHOT;
+
+// 一个统计窗口内的耗时
+typedef struct
+{
+    uint32_t min_us;
+    uint32_t avg_us;
+    uint32_t max_us;
+    uint32_t count;
+} STAGE_WINDOW;
+
+// 热路径调用, 无锁
+extern void metricsInc(METRIC_COUNTER counter, uint32_t n = 1);
+extern void metricsObserve(METRIC_HISTOGRAM histogram, uint32_t value_us);
+extern void metricsStage(PIPELINE_STAGE stage, uint32_t value_us);
+
+// 读取计数器当前值
+extern uint32_t metricsGet(METRIC_COUNTER counter);
+
+extern void metricsSetPool(const POOL_SNAPSHOT &pool);
+extern void metricsGetPool(POOL_SNAPSHOT &pool);
+
+// 读取并清空一个阶段的统计窗口
+extern void metricsTakeStageWindow(PIPELINE_STAGE stage, STAGE_WINDOW &window);
+extern const char *metricsStageName(PIPELINE_STAGE stage);
+
+#ifdef ARDUINO
+// 登记需要上报栈水位的任务
+extern void metricsRegisterTask(const char *name, TaskHandle_t task);
+
+// 提供 GET /metrics 的HTTP服务任务
+extern void taskMetricsServer(void *param);
+#endif
+
+#endif
@@ -0,0 +1,10 @@
+#ifndef _NATIVE_REPLAY_H_
+#define _NATIVE_REPLAY_H_
+
+/*
+ * env:native 回放入口, 参数与命令行相同 (见 src/native/main_native.cpp)
+ * 程序的main和 test/test_golden 都通过它运行, 返回值即退出码
+ */
+extern int nativeReplay(int argc, char *argv[]);
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef _PNG_IMAGE_H_
+#define _PNG_IMAGE_H_
+
+#include <stdint.h>
+#include <vector>
+
+/*
+ * env:native 的PNG读写 (8位RGB, 不隔行), 用于保存画面和回放的参考图像
+ * 压缩由zlib完成; 读取支持全部五种行过滤, 经其他工具重新压缩的参考图像也可以使用
+ */
+
+// rgb为 width * height * 3 字节
+extern bool pngWrite(const char *path, const uint8_t *rgb, uint32_t width, uint32_t height);
+extern bool pngRead(const char *path, std::vector<uint8_t> &rgb, uint32_t *width, uint32_t *height);
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef _POWER_MANAGER_H_
+#define _POWER_MANAGER_H_
+
+#include <stdint.h>
+#include "config.h"
+#include "public.h"
+
+#define powerPrintLog(format, arg...) UARTPrintf("\r\n[POWER] " format, ##arg)
+
+// 以下参数可在config.h中覆盖
+#ifndef POWER_DIM_TIMEOUT
+#define POWER_DIM_TIMEOUT (30 * 1000)       // 多久没有新数据后调暗背光 (毫秒)
+#endif
+#ifndef POWER_IDLE_TIMEOUT
+#define POWER_IDLE_TIMEOUT (5 * 60 * 1000)  // 多久没有新数据后进入空闲 (毫秒)
+#endif
+#ifndef BACKLIGHT_FULL_LEVEL
+#define BACKLIGHT_FULL_LEVEL 255
+#endif
+#ifndef BACKLIGHT_DIM_LEVEL
+#define BACKLIGHT_DIM_LEVEL 40
+#endif
+#ifndef CPU_ACTIVE_MHZ
+#define CPU_ACTIVE_MHZ 240
+#endif
+#ifndef CPU_IDLE_MHZ
+#define CPU_IDLE_MHZ 80                     // WiFi要求不低于80MHz
+#endif
+
+enum POWER_STATE {
+    POWER_ACTIVE,   // 全亮度, 全速渲染
+    POWER_DIMMED,   // 数据暂停: 调暗背光, 继续刷新时钟
+    POWER_IDLE,     // 数据长时间中断: 关闭背光, 暂停渲染, 降低CPU频率
+    POWER_STATE_MAX,
+};
+
+/*
+ * 电源状态机, 由数据新鲜度驱动
+ * 所有状态切换都在loop()中执行; 其他任务只能通过requestSleep()提出请求
+ */
+class PowerManager {
+public:
+    PowerManager();
+
+    void begin();
+
+    // loop()中每次调用, 根据数据新鲜度切换状态
+    void service();
+
+    // 新数据帧已应用 / 触摸等用户操作
+    void onDataArrived();
+
+    // 外部强制进入空闲 (例如WiFi长时间未连接), 可在任意任务调用
+    void requestSleep(bool enable) { sleep_requested = enable; }
+
+    // 空闲时可以延长loop()的休眠时间
+    uint32_t adjustWait(uint32_t wait) const;
+
+    POWER_STATE getState() const { return state; }
+    unsigned long getStateTime(POWER_STATE s) const;
+
+private:
+    POWER_STATE state;
+    volatile bool sleep_requested;
+    unsigned long last_activity;
+    unsigned long state_enter;
+    unsigned long last_report;
+    unsigned long state_time[POWER_STATE_MAX];
+
+    void enterState(POWER_STATE next);
+    void reportStateTimes();
+};
+
+// 全局电源管理器实例
+extern PowerManager powerManager;
+
+#endif
@@ -1,8 +1,12 @@
 #ifndef _PUBLIC_H_
 #define _PUBLIC_H_
 
-#define UARTPrint(format) Serial.print(format)
-#define UARTPrintf(format, arg...) Serial.printf(format, ##arg)
+#include "log.h"
+
+// 日志经环形缓冲区异步输出, 调试等级的调用在默认配置下不参与编译
+#define UARTPrint(format) UARTPrintf("%s", format)
+#define UARTPrintf(format, arg...) LOG_AT(LOG_LEVEL_INFO, format, ##arg)
+#define UARTDebugf(format, arg...) LOG_AT(LOG_LEVEL_DEBUG, format, ##arg)
 
 typedef struct
 {
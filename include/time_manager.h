@@ -3,34 +3,66 @@
 
 #include <WiFi.h>
 #include <time.h>
+#include <sys/time.h>
 #include "config.h"
 
+// 时间同步状态, 全部在loop()中推进, 不等待SNTP应答
+enum TIME_SYNC_STATE {
+    TIME_SYNC_IDLE,         // 尚未启动SNTP (等待WiFi)
+    TIME_SYNC_WAITING,      // 已发出请求, 等待SNTP回调
+    TIME_SYNC_SYNCED,       // 已同步, 由SNTP按NTP_UPDATE_INTERVAL周期性重新同步
+};
+
 class TimeManager {
 private:
     unsigned long last_ntp_sync;
-    unsigned long last_time_update;
     bool time_synced;
     
+    TIME_SYNC_STATE state;
+    unsigned long request_ms;       // 最近一次发出同步请求的时间
+    uint32_t request_us;
+    uint8_t retries;
+    
+    // 上一次同步时的墙上时间和本地计时, 用于估算下一次同步时的时钟偏差
+    struct timeval last_sync_tv;
+    int64_t last_sync_us;
+    
+    // 统计, 由指标服务读取
+    uint32_t sync_latency_us;
+    int32_t clock_offset_us;
+    uint32_t sync_count;
+    
+    static void onTimeSync(struct timeval *tv);
+    void handleSync(const struct timeval &tv, int64_t sync_us);
+    void requestSync();
+    
 public:
     TimeManager();
     
-    // 初始化NTP时间同步
+    // 启动NTP时间同步, 立即返回, 同步结果由SNTP回调通知
     void initNTP();
     
-    // 获取当前时间字符串 (HH:MM:SS格式)
-    String getCurrentTimeString();
-    
     // 获取当前日期时间字符串 (YYYY-MM-DD HH:MM:SS格式)
     String getCurrentDateTimeString();
     
-    // 检查是否需要重新同步时间
+    // 在loop()中调用: 处理SNTP回调结果, 超时重试
     void checkAndSyncTime();
     
     // 获取时间同步状态
     bool isTimeSynced() const { return time_synced; }
+    TIME_SYNC_STATE getSyncState() const { return state; }
     
-    // 强制同步时间
+    // 本地时间的当日秒数, 由单调计时加上最近一次同步的时间推算, 不查询系统时间; 未同步时返回-1
+    int32_t getSecondsOfDay() const;
+    
+    // 请求SNTP立即重新同步 (不等待结果)
     void forceSyncTime();
+    
+    // 最近一次同步: 请求到回调的耗时, 以及本地时钟相对NTP的偏差 (首次同步时为0)
+    uint32_t getSyncLatencyUs() const { return sync_latency_us; }
+    int32_t getClockOffsetUs() const { return clock_offset_us; }
+    uint32_t getSyncCount() const { return sync_count; }
+    unsigned long getLastSyncMs() const { return last_ntp_sync; }
 };
 
 // 全局时间管理器实例
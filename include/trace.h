@@ -0,0 +1,110 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#endif
+
+/*
+ * 二进制跟踪缓冲区
+ * 跟踪点只写入一个12字节的事件到内存环形缓冲区, 满后覆盖最旧的事件;
+ * 通过串口或 http://<设备IP>:9100/trace 导出, 由 tools/trace2chrome.py 转换为Chrome trace JSON
+ */
+
+// 编译期开关, 关闭后跟踪点不参与编译; env:native没有FreeRTOS任务, 默认关闭
+#ifndef TRACE_ENABLE
+#ifdef ARDUINO
+#define TRACE_ENABLE 1
+#else
+#define TRACE_ENABLE 0
+#endif
+#endif
+
+// 环形缓冲区事件数 (2的幂)
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS 512
+#endif
+
+#define TRACE_MAGIC 0x43525441      // "ATRC"
+#define TRACE_VERSION 1
+#define TRACE_NAME_SIZE 16
+
+// 跟踪点, 名称见 trace.cpp 中的 traceNames
+enum TRACE_ID {
+    TRACE_LOOP,             // loop() 一次迭代
+    TRACE_HTTP_RECV,        // SSE recv()
+    TRACE_HTTP_FRAME,       // 一次recv后的帧组装和解析
+    TRACE_PARSE,            // parseAida64Data
+    TRACE_DISPATCH,         // updateSystemInfo
+    TRACE_REFRESH,          // LVGL刷新定时器 (渲染 + 刷新)
+    TRACE_FLUSH,            // disp_flush 一块区域
+    TRACE_ID_MAX,
+};
+
+enum TRACE_TYPE {
+    TRACE_BEGIN,
+    TRACE_END,
+};
+
+// 导出格式: TRACE_HEADER, task_count个TRACE_TASK, TRACE_ID_MAX个名称, count个TRACE_EVENT (小端)
+typedef struct
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t event_size;
+    uint32_t count;
+    uint16_t task_count;
+    uint16_t name_count;
+} TRACE_HEADER;
+
+typedef struct
+{
+    uint32_t task;
+    char name[TRACE_NAME_SIZE];
+} TRACE_TASK;
+
+typedef struct
+{
+    uint32_t time_us;       // esp_timer时间戳, 两个核心共用且不受CPU调频影响
+    uint32_t task;          // 任务句柄
+    uint8_t id;
+    uint8_t type;
+    uint8_t core;
+    uint8_t reserved;
+} TRACE_EVENT;
+
+#if TRACE_ENABLE
+extern void traceEvent(TRACE_ID id, TRACE_TYPE type);
+
+// 作用域跟踪: 构造时写BEGIN, 析构时写END
+class TraceScope {
+public:
+    explicit TraceScope(TRACE_ID id) : id(id) { traceEvent(id, TRACE_BEGIN); }
+    ~TraceScope() { traceEvent(id, TRACE_END); }
+
+private:
+    TRACE_ID id;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+#define TRACE_SCOPE(id) TraceScope TRACE_CONCAT(_trace_scope_, __LINE__)(id)
+#define TRACE_BEGIN_EVENT(id) traceEvent(id, TRACE_BEGIN)
+#define TRACE_END_EVENT(id) traceEvent(id, TRACE_END)
+#else
+#define TRACE_SCOPE(id) do {} while (0)
+#define TRACE_BEGIN_EVENT(id) do {} while (0)
+#define TRACE_END_EVENT(id) do {} while (0)
+#endif
+
+#ifdef ARDUINO
+// 导出期间暂停记录, 导出完成后清空缓冲区
+extern void traceDump(Print &out);
+
+// 串口导出: 每行 "TRACE:" + 十六进制数据, 由 loop() 在收到 't' 时调用
+extern void traceDumpSerial();
+#endif
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef _WARM_CACHE_H_
+#define _WARM_CACHE_H_
+
+#include <stdint.h>
+#include <vector>
+#include "public.h"
+#include "aida64_layout.h"
+
+#define warmPrintLog(format, arg...) UARTPrintf("\r\n[WARM] " format, ##arg)
+
+/*
+ * 热启动缓存
+ * 最近一帧数据和布局以紧凑的二进制快照保存在RTC内存 (软复位后保留) 和NVS (断电后保留),
+ * 开机时先显示快照 (灰色, 表示过期), 收到实时数据后逐项替换
+ */
+
+// 读取快照, RTC内存优先; 没有有效快照时返回false
+extern bool warmCacheLoad(std::vector<AIDA64_LAYOUT_ITEM> &layout, std::vector<AIDA64_DATA> &frame);
+
+// 显示任务应用一帧后调用, 按限定的频率写入RTC内存和NVS
+extern void warmCacheUpdate(const std::vector<AIDA64_DATA> &frame);
+
+#endif
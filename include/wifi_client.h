@@ -1,9 +1,13 @@
 #ifndef _WIFI_CLIENT_H_
 #define _WIFI_CLIENT_H_
 #include <WiFi.h>
+#include "wifi_state.h"
 
 #define wifiPrintLog(format, arg...) UARTPrintf("\r\n[WIFI] " format, ##arg)
 
 extern void taskWifiClient(void *param);
 
-#endif
\ No newline at end of file
+// 最近一次按该方式连接的耗时 (断开/启动 -> 获得IP), count返回该方式的成功次数
+extern uint32_t getWifiConnectMs(WIFI_CONNECT_PATH path, uint32_t *count);
+
+#endif
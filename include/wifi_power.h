@@ -0,0 +1,77 @@
+#ifndef _WIFI_POWER_H_
+#define _WIFI_POWER_H_
+
+#include <Arduino.h>
+#include <mutex>
+#include "public.h"
+
+#define wifiPowerPrintLog(format, arg...) UARTPrintf("\r\n[WIFI PS] " format, ##arg)
+
+// 无线省电模式
+enum WIFI_PS_MODE {
+    WIFI_PS_MODE_NONE,      // 不省电, 数据到达延迟最小
+    WIFI_PS_MODE_MODEM,     // modem sleep, 下行数据按DTIM缓存, 到达时间抖动变大
+    WIFI_PS_MODE_MAX,
+};
+
+#define WIFI_PS_SAMPLES 64
+
+// 一种模式下最近的SSE帧到达间隔 (不是传输延迟: 间隔主要由AIDA64的发送周期决定,
+// 省电模式的影响体现在间隔相对中位数的抖动上)
+typedef struct
+{
+    uint16_t interval_ms[WIFI_PS_SAMPLES];
+    uint8_t next;
+    uint8_t filled;
+    uint32_t count;
+    uint32_t sum_ms;
+} WIFI_PS_STATS;
+
+typedef struct
+{
+    uint32_t p50_ms;
+    uint32_t p90_ms;
+    uint32_t p99_ms;
+    uint32_t jitter_p90_ms;     // |间隔 - 中位数| 的p90, 即相对预期发送周期的到达抖动
+    uint32_t count;
+    uint32_t sum_ms;
+} WIFI_PS_SUMMARY;
+
+/*
+ * 自适应省电策略
+ * 有数据流时关闭省电; 数据中断后进入modem sleep;
+ * 数据流较慢时定期试探modem sleep, 到达抖动超出预算则退回并等待下一次试探
+ */
+class WifiPowerPolicy {
+public:
+    WifiPowerPolicy();
+
+    // HTTP任务每收到一帧调用
+    void onFrame(uint32_t arrival_us);
+
+    // WiFi任务周期调用; connected为false时不切换模式, 重新连接后立即重新应用
+    void service(bool connected);
+
+    WIFI_PS_MODE getMode() const { return mode; }
+    void getSummary(WIFI_PS_MODE mode, WIFI_PS_SUMMARY &summary);
+    static const char *modeName(WIFI_PS_MODE mode);
+
+private:
+    std::mutex lock;
+    WIFI_PS_STATS stats[WIFI_PS_MODE_MAX];
+    uint32_t last_arrival_us;
+    unsigned long last_frame_ms;
+
+    WIFI_PS_MODE mode;
+    bool applied;
+    bool probing;               // 有数据流时的modem sleep试探
+    unsigned long next_probe;
+    uint32_t probe_start_count;
+
+    void setMode(WIFI_PS_MODE next, const char *reason);
+    void summarize(const WIFI_PS_STATS &stats, WIFI_PS_SUMMARY &summary);
+};
+
+extern WifiPowerPolicy wifiPowerPolicy;
+
+#endif
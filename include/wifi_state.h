@@ -0,0 +1,97 @@
+#ifndef _WIFI_STATE_H_
+#define _WIFI_STATE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * WiFi连接状态机
+ * 不依赖Arduino/ESP-IDF: 事件和时间由调用方传入, 所有操作通过WifiDriver完成,
+ * 主机上可以用假的驱动和事件序列直接驱动
+ */
+
+// 快速连接缓存: 上次成功连接的AP和IP配置, 重连时跳过扫描和DHCP
+typedef struct
+{
+    uint8_t valid;
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip;            // 网络字节序, 与IPAddress一致
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+} WIFI_CACHE;
+
+enum WIFI_SM_EVENT {
+    WIFI_SM_ASSOCIATED,     // 已关联AP
+    WIFI_SM_GOT_IP,         // 已获得IP (DHCP或静态)
+    WIFI_SM_DISCONNECTED,
+};
+
+// 与ESP-IDF的 WIFI_REASON_ASSOC_LEAVE 相同 (wifi_client.cpp 中有静态检查)
+#define WIFI_SM_REASON_ASSOC_LEAVE 8
+
+// 驱动上报的断开原因是否算作连接失败; 重新配置时自己发起的断开 (ASSOC_LEAVE) 不算
+extern bool wifiDisconnectIsFailure(uint8_t reason);
+
+enum WIFI_SM_STATE {
+    WIFI_SM_IDLE,
+    WIFI_SM_FAST_CONNECT,   // 按缓存的BSSID/信道/IP直接连接
+    WIFI_SM_SCAN_CONNECT,   // 完整扫描 + DHCP
+    WIFI_SM_CONNECTED,
+    WIFI_SM_STATE_MAX,
+};
+
+// 连接方式, 用于统计连接耗时
+enum WIFI_CONNECT_PATH {
+    WIFI_PATH_FAST,
+    WIFI_PATH_SCAN,
+    WIFI_PATH_MAX,
+};
+
+class WifiDriver {
+public:
+    virtual ~WifiDriver() {}
+
+    // cache为NULL时完整扫描并使用DHCP
+    virtual void connect(const WIFI_CACHE *cache) = 0;
+
+    // 读取当前连接的AP和IP配置
+    virtual bool readCache(WIFI_CACHE &cache) = 0;
+    virtual bool loadCache(WIFI_CACHE &cache) = 0;
+    virtual void saveCache(const WIFI_CACHE &cache) = 0;
+
+    // 长时间未连接时关闭屏幕, 连接后恢复
+    virtual void setOffline(bool offline) = 0;
+
+    virtual void onConnected(WIFI_CONNECT_PATH path, uint32_t connect_ms) {}
+    virtual void onReconnect() {}
+};
+
+class WifiStateMachine {
+public:
+    explicit WifiStateMachine(WifiDriver &driver);
+
+    void start(uint32_t now_ms);
+    void onEvent(WIFI_SM_EVENT event, uint32_t now_ms);
+
+    // 周期调用, 处理超时
+    void tick(uint32_t now_ms);
+
+    WIFI_SM_STATE getState() const { return state; }
+    static const char *stateName(WIFI_SM_STATE state);
+
+private:
+    WifiDriver &driver;
+    WIFI_SM_STATE state;
+    WIFI_CACHE cache;
+    uint32_t attempt_start;     // 本次连接尝试开始时间 (超时)
+    uint32_t offline_start;     // 断开时间 (连接耗时、关屏)
+    bool offline;
+
+    void connectFast(uint32_t now_ms);
+    void connectScan(uint32_t now_ms);
+    void enterState(WIFI_SM_STATE next);
+};
+
+#endif
@@ -14,7 +14,8 @@
 #define LV_COLOR_DEPTH 16
 
 /*Swap the 2 bytes of RGB565 color. Useful if the display has an 8-bit interface (e.g. SPI)*/
-#define LV_COLOR_16_SWAP 0
+/*Rendered pre-swapped so disp_flush can push the buffer without per-pixel swapping*/
+#define LV_COLOR_16_SWAP 1
 
 /*Enable more complex drawing routines to manage screens transparency.
  *Can be used if the UI is above another layer, e.g. an OSD menu or video player.*/
@@ -62,8 +63,8 @@
 /*Use a custom tick source that tells the elapsed time in milliseconds.*/
 #define LV_TICK_CUSTOM 1
 #if LV_TICK_CUSTOM
-    #define LV_TICK_CUSTOM_INCLUDE "Arduino.h"         /*Header for the system time function*/
-    #define LV_TICK_CUSTOM_SYS_TIME_EXPR (millis())    /*Expression evaluating to current system time in ms*/
+    #define LV_TICK_CUSTOM_INCLUDE "hal.h"             /*Header for the system time function*/
+    #define LV_TICK_CUSTOM_SYS_TIME_EXPR (halMillis()) /*Expression evaluating to current system time in ms*/
 #endif   /*LV_TICK_CUSTOM*/
 
 /*Default Dot Per Inch. Used to initialize default sizes such as widgets sized, style paddings.
@@ -294,7 +295,11 @@
 #define LV_FONT_MONTSERRAT_8  0
 #define LV_FONT_MONTSERRAT_10 0
 #define LV_FONT_MONTSERRAT_12 0
+#ifdef AIDA64_FONT_SUBSET
+#define LV_FONT_MONTSERRAT_14 0     /*由构建时生成的子集字体代替, 见下方LV_FONT_DEFAULT*/
+#else
 #define LV_FONT_MONTSERRAT_14 1
+#endif
 #define LV_FONT_MONTSERRAT_16 0
 #define LV_FONT_MONTSERRAT_18 0
 #define LV_FONT_MONTSERRAT_20 0
@@ -326,10 +331,20 @@
 /*Optionally declare custom fonts here.
  *You can use these fonts as default font too and they will be available globally.
  *E.g. #define LV_FONT_CUSTOM_DECLARE   LV_FONT_DECLARE(my_font_1) LV_FONT_DECLARE(my_font_2)*/
+/*AIDA64_FONT_SUBSET由 tools/font_subset.py 在构建前定义: 只包含界面实际绘制的字形 (src/fonts/aida64_font_14.c),
+ *生成失败时仍使用完整的Montserrat*/
+#ifdef AIDA64_FONT_SUBSET
+#define LV_FONT_CUSTOM_DECLARE LV_FONT_DECLARE(aida64_font_14)
+#else
 #define LV_FONT_CUSTOM_DECLARE
+#endif
 
 /*Always set a default font*/
+#ifdef AIDA64_FONT_SUBSET
+#define LV_FONT_DEFAULT &aida64_font_14
+#else
 #define LV_FONT_DEFAULT &lv_font_montserrat_14
+#endif
 
 /*Enable handling large font and/or fonts with a lot of characters.
  *The limit depends on the font size, font face and bpp but with > 10,000 characters
@@ -0,0 +1,449 @@
+#include "aida64_binary.h"
+#include <string.h>
+#include "fixed_format.h"
+#include "metrics.h"
+#include "trace.h"
+#include "alloc_track.h"
+
+// 带边界检查的读写位置, 越界后只置标志, 由调用方统一判断
+typedef struct
+{
+    uint8_t *buf;
+    size_t size;
+    size_t pos;
+    bool overflow;
+} BIN_WRITER;
+
+typedef struct
+{
+    const uint8_t *buf;
+    size_t size;
+    size_t pos;
+    bool underflow;
+} BIN_READER;
+
+static void putByte(BIN_WRITER &writer, uint8_t value)
+{
+    if (writer.pos >= writer.size) {
+        writer.overflow = true;
+        return;
+    }
+    writer.buf[writer.pos++] = value;
+}
+
+static void putVarint(BIN_WRITER &writer, uint32_t value)
+{
+    while (value >= 0x80) {
+        putByte(writer, (value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    putByte(writer, value);
+}
+
+static void putString(BIN_WRITER &writer, const char *text)
+{
+    size_t len = strlen(text);
+
+    if (len > 0xff) {
+        len = 0xff;
+    }
+    putByte(writer, len);
+    for (size_t i = 0; i < len; i++) {
+        putByte(writer, text[i]);
+    }
+}
+
+static uint8_t getByte(BIN_READER &reader)
+{
+    if (reader.pos >= reader.size) {
+        reader.underflow = true;
+        return 0;
+    }
+    return reader.buf[reader.pos++];
+}
+
+static uint32_t getVarint(BIN_READER &reader)
+{
+    uint32_t value = 0;
+
+    for (int shift = 0; shift < 35; shift += 7) {
+        uint8_t byte = getByte(reader);
+        value |= (uint32_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return value;
+        }
+    }
+    reader.underflow = true;
+    return 0;
+}
+
+// 读取长度前缀字符串, 超出dst的部分丢弃
+static void getString(BIN_READER &reader, char *dst, size_t size)
+{
+    size_t len = getByte(reader);
+    size_t out = 0;
+
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = getByte(reader);
+        if (out < size - 1) {
+            dst[out++] = c;
+        }
+    }
+    dst[out] = '\0';
+}
+
+static uint32_t zigzag(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+uint16_t aida64BinaryCrc(const uint8_t *data, size_t len)
+{
+    // CRC-16/CCITT-FALSE, 帧只有几十字节, 不用查表
+    uint16_t crc = 0xffff;
+
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+bool aida64BinaryNextFrame(AIDA64_STREAM &stream, AIDA64_BIN_FRAME &frame)
+{
+    const uint8_t *start;
+    size_t avail;
+
+    while (1) {
+        start = (const uint8_t *)stream.buffer + stream.scan;
+        avail = stream.length - stream.scan;
+        if (avail < AIDA64_BIN_HEADER_SIZE) {
+            break;
+        }
+
+        // 头部不合法时按字节向后重新同步
+        uint16_t length = start[6] | (start[7] << 8);
+        size_t total = AIDA64_BIN_HEADER_SIZE + length + ((start[3] & AIDA64_BIN_FLAG_CRC) ? AIDA64_BIN_CRC_SIZE : 0);
+        if (start[0] != AIDA64_BIN_MAGIC || start[1] != AIDA64_BIN_VERSION || total > AIDA64_BIN_MAX_FRAME) {
+            stream.scan++;
+            continue;
+        }
+        if (avail < total) {
+            break;
+        }
+
+        if (start[3] & AIDA64_BIN_FLAG_CRC) {
+            const uint8_t *crc = start + AIDA64_BIN_HEADER_SIZE + length;
+            if (aida64BinaryCrc(start, AIDA64_BIN_HEADER_SIZE + length) != (crc[0] | (crc[1] << 8))) {
+                binaryPrintLog("CRC mismatch, resyncing\r\n");
+                metricsInc(METRIC_FRAMES_DROPPED);
+                stream.scan++;
+                continue;
+            }
+        }
+
+        frame.type = start[2];
+        frame.flags = start[3];
+        frame.seq = start[4] | (start[5] << 8);
+        frame.length = length;
+        frame.payload = start + AIDA64_BIN_HEADER_SIZE;
+        stream.scan += total;
+        return true;
+    }
+
+    // 不完整的帧移到缓冲区开头, 等待后续数据
+    stream.length -= stream.scan;
+    memmove(stream.buffer, stream.buffer + stream.scan, stream.length + 1);
+    stream.scan = 0;
+    return false;
+}
+
+void aida64BinaryDecoderReset(AIDA64_BIN_DECODER &decoder)
+{
+    decoder.items.clear();
+    decoder.frame.clear();
+    decoder.layout_crc = 0;
+    decoder.seq = 0;
+    decoder.synced = false;
+}
+
+bool aida64BinaryLayoutChanged(const AIDA64_BIN_DECODER &decoder, const AIDA64_BIN_FRAME &frame)
+{
+    return decoder.items.empty() || aida64BinaryCrc(frame.payload, frame.length) != decoder.layout_crc;
+}
+
+bool aida64BinaryDecodeLayout(AIDA64_BIN_DECODER &decoder, const AIDA64_BIN_FRAME &frame,
+                              std::vector<AIDA64_LAYOUT_ITEM> &layout)
+{
+    BIN_READER reader = {frame.payload, frame.length, 0, false};
+    AIDA64_LAYOUT_ITEM item;
+    AIDA64_BIN_ITEM state;
+    AIDA64_DATA data;
+    uint8_t count = getByte(reader);
+
+    if (count > AIDA64_BIN_MAX_ITEMS) {
+        return false;
+    }
+    // 相同的布局 (中继补发或组播重发): 保留项目表、最近值和同步状态
+    if (!aida64BinaryLayoutChanged(decoder, frame)) {
+        return false;
+    }
+
+    layout.clear();
+    aida64BinaryDecoderReset(decoder);
+    for (int i = 0; i < count; i++) {
+        memset(&item, 0, sizeof(item));
+        getString(reader, item.id, sizeof(item.id));
+        getString(reader, item.label, sizeof(item.label));
+        getString(reader, item.unit, sizeof(item.unit));
+        item.numeric = getByte(reader) ? 1 : 0;
+        // 值中不带标签, prefix留空, 显示侧直接从值中取数
+        layout.push_back(item);
+
+        memset(&state, 0, sizeof(state));
+        state.numeric = item.numeric;
+        decoder.items.push_back(state);
+
+        memset(&data, 0, sizeof(data));
+        strcpy(data.id, item.id);
+        decoder.frame.push_back(data);
+    }
+
+    if (reader.underflow) {
+        layout.clear();
+        aida64BinaryDecoderReset(decoder);
+        return false;
+    }
+
+    decoder.layout_crc = aida64BinaryCrc(frame.payload, frame.length);
+    decoder.seq = frame.seq;
+    binaryPrintLog("Layout with %d items\r\n", count);
+    return true;
+}
+
+bool aida64BinaryDecodeData(AIDA64_BIN_DECODER &decoder, const AIDA64_BIN_FRAME &frame,
+                            std::vector<AIDA64_DATA> &dataList)
+{
+    TRACE_SCOPE(TRACE_PARSE);
+    ALLOC_STAGE(STAGE_PARSE);
+    BIN_READER reader = {frame.payload, frame.length, 0, false};
+
+    // 只处理数据帧; 其他类型 (包括新版本增加的) 直接忽略, 不影响同步状态
+    if (frame.type != AIDA64_BIN_KEYFRAME && frame.type != AIDA64_BIN_DELTA) {
+        return false;
+    }
+    if (decoder.items.empty()) {
+        return false;
+    }
+    // 差分帧依赖上一帧, 丢帧后等待关键帧
+    if (frame.type == AIDA64_BIN_DELTA && (!decoder.synced || frame.seq != (uint16_t)(decoder.seq + 1))) {
+        if (decoder.synced) {
+            binaryPrintLog("Sequence gap %u -> %u, waiting for keyframe\r\n", decoder.seq, frame.seq);
+        }
+        decoder.synced = false;
+        return false;
+    }
+
+    uint8_t count = getByte(reader);
+    for (int i = 0; i < count && !reader.underflow; i++) {
+        uint8_t index = getByte(reader);
+        if (index >= decoder.items.size()) {
+            reader.underflow = true;
+            break;
+        }
+
+        AIDA64_BIN_ITEM &item = decoder.items[index];
+        char *val = decoder.frame[index].val;
+        val[0] = '>';
+        if (item.numeric) {
+            // 关键帧相对0编码, 差分帧相对上一帧
+            int32_t base = frame.type == AIDA64_BIN_KEYFRAME ? 0 : item.value;
+            item.value = (int32_t)((uint32_t)base + (uint32_t)unzigzag(getVarint(reader)));
+            formatFixed(val + 1, sizeof(decoder.frame[index].val) - 1, item.value, FIXED_DECIMALS, FIXED_DECIMALS);
+        } else {
+            getString(reader, item.text, sizeof(item.text));
+            strncpy(val + 1, item.text, sizeof(decoder.frame[index].val) - 2);
+            val[sizeof(decoder.frame[index].val) - 1] = '\0';
+        }
+        item.valid = 1;
+    }
+
+    if (reader.underflow) {
+        binaryPrintLog("Malformed frame %u, waiting for keyframe\r\n", frame.seq);
+        decoder.synced = false;
+        return false;
+    }
+
+    decoder.seq = frame.seq;
+    decoder.synced = true;
+
+    // 与SSE解析结果一致: 每帧包含全部已知项目, 容量保留, 稳定后不再分配内存
+    dataList.clear();
+    for (size_t i = 0; i < decoder.items.size(); i++) {
+        if (decoder.items[i].valid) {
+            dataList.push_back(decoder.frame[i]);
+        }
+    }
+    return true;
+}
+
+void aida64BinaryEncoderInit(AIDA64_BIN_ENCODER &encoder, const std::vector<AIDA64_LAYOUT_ITEM> &layout,
+                             uint32_t keyframe_interval, bool crc)
+{
+    AIDA64_BIN_ITEM state;
+
+    encoder.layout.assign(layout.begin(), layout.begin() + (layout.size() < AIDA64_BIN_MAX_ITEMS ? layout.size() : AIDA64_BIN_MAX_ITEMS));
+    encoder.items.clear();
+    for (const auto &item : encoder.layout) {
+        memset(&state, 0, sizeof(state));
+        state.numeric = item.numeric;
+        encoder.items.push_back(state);
+    }
+    encoder.seq = 0;
+    encoder.frames = 0;
+    encoder.keyframe_interval = keyframe_interval;
+    encoder.crc = crc;
+}
+
+// 负载已写在头部之后, 补上头部和CRC
+static size_t finishFrame(const AIDA64_BIN_ENCODER &encoder, uint8_t type, uint16_t seq, BIN_WRITER &writer)
+{
+    size_t length = writer.pos - AIDA64_BIN_HEADER_SIZE;
+
+    if (encoder.crc) {
+        // 预留CRC的位置
+        putByte(writer, 0);
+        putByte(writer, 0);
+    }
+    if (writer.overflow || length > 0xffff || writer.pos > AIDA64_BIN_MAX_FRAME) {
+        return 0;
+    }
+
+    uint8_t *out = writer.buf;
+    out[0] = AIDA64_BIN_MAGIC;
+    out[1] = AIDA64_BIN_VERSION;
+    out[2] = type;
+    out[3] = encoder.crc ? AIDA64_BIN_FLAG_CRC : 0;
+    out[4] = seq & 0xff;
+    out[5] = seq >> 8;
+    out[6] = length & 0xff;
+    out[7] = length >> 8;
+    if (encoder.crc) {
+        uint16_t crc = aida64BinaryCrc(out, AIDA64_BIN_HEADER_SIZE + length);
+        out[AIDA64_BIN_HEADER_SIZE + length] = crc & 0xff;
+        out[AIDA64_BIN_HEADER_SIZE + length + 1] = crc >> 8;
+    }
+    return writer.pos;
+}
+
+size_t aida64BinaryEncodeLayout(const AIDA64_BIN_ENCODER &encoder, uint8_t *out, size_t size)
+{
+    BIN_WRITER writer = {out, size, AIDA64_BIN_HEADER_SIZE, size < AIDA64_BIN_HEADER_SIZE};
+
+    putByte(writer, encoder.layout.size());
+    for (const auto &item : encoder.layout) {
+        putString(writer, item.id);
+        putString(writer, item.label);
+        putString(writer, item.unit);
+        putByte(writer, item.numeric);
+    }
+    return finishFrame(encoder, AIDA64_BIN_LAYOUT, encoder.seq, writer);
+}
+
+// 写入数值记录: previous为NULL时为关键帧 (全部有效项目, 相对0)
+static void putItems(const AIDA64_BIN_ENCODER &encoder, BIN_WRITER &writer,
+                     const std::vector<bool> *changed, const std::vector<int32_t> *previous)
+{
+    uint8_t count = 0;
+
+    for (size_t i = 0; i < encoder.items.size(); i++) {
+        if (encoder.items[i].valid && (changed == NULL || (*changed)[i])) {
+            count++;
+        }
+    }
+
+    putByte(writer, count);
+    for (size_t i = 0; i < encoder.items.size(); i++) {
+        const AIDA64_BIN_ITEM &item = encoder.items[i];
+        if (!item.valid || !(changed == NULL || (*changed)[i])) {
+            continue;
+        }
+
+        putByte(writer, i);
+        if (item.numeric) {
+            int32_t base = previous ? (*previous)[i] : 0;
+            putVarint(writer, zigzag((int32_t)((uint32_t)item.value - (uint32_t)base)));
+        } else {
+            putString(writer, item.text);
+        }
+    }
+}
+
+size_t aida64BinaryEncodeKeyframe(const AIDA64_BIN_ENCODER &encoder, uint8_t *out, size_t size)
+{
+    BIN_WRITER writer = {out, size, AIDA64_BIN_HEADER_SIZE, size < AIDA64_BIN_HEADER_SIZE};
+
+    putItems(encoder, writer, NULL, NULL);
+    return finishFrame(encoder, AIDA64_BIN_KEYFRAME, encoder.seq, writer);
+}
+
+static int findLayoutItem(const AIDA64_BIN_ENCODER &encoder, const char *id)
+{
+    for (size_t i = 0; i < encoder.layout.size(); i++) {
+        if (strcmp(encoder.layout[i].id, id) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+size_t aida64BinaryEncodeData(AIDA64_BIN_ENCODER &encoder, const std::vector<AIDA64_DATA> &dataList,
+                              uint8_t *out, size_t size)
+{
+    BIN_WRITER writer = {out, size, AIDA64_BIN_HEADER_SIZE, size < AIDA64_BIN_HEADER_SIZE};
+    bool keyframe = encoder.frames == 0 || (encoder.keyframe_interval > 0 && encoder.frames >= encoder.keyframe_interval);
+    std::vector<bool> changed(encoder.items.size(), false);
+    std::vector<int32_t> previous(encoder.items.size());
+
+    // 与显示侧相同的取值方式: 跳过标签, 数值按定点数解析
+    for (const auto &data : dataList) {
+        int index = findLayoutItem(encoder, data.id);
+        if (index < 0) {
+            continue;
+        }
+
+        AIDA64_BIN_ITEM &item = encoder.items[index];
+        const char *value = findAida64Value(data.val, encoder.layout[index].prefix);
+        previous[index] = item.value;
+        if (item.numeric) {
+            int32_t number;
+            if (parseFixed(value, FIXED_DECIMALS, &number) == NULL) {
+                continue;
+            }
+            changed[index] = !item.valid || number != item.value;
+            item.value = number;
+        } else {
+            changed[index] = !item.valid || strncmp(value, item.text, sizeof(item.text) - 1) != 0;
+            strncpy(item.text, value, sizeof(item.text) - 1);
+            item.text[sizeof(item.text) - 1] = '\0';
+        }
+        item.valid = 1;
+    }
+
+    if (keyframe) {
+        putItems(encoder, writer, NULL, NULL);
+    } else {
+        putItems(encoder, writer, &changed, &previous);
+    }
+
+    encoder.frames = keyframe ? 1 : encoder.frames + 1;
+    encoder.seq++;
+    return finishFrame(encoder, keyframe ? AIDA64_BIN_KEYFRAME : AIDA64_BIN_DELTA, encoder.seq, writer);
+}
@@ -0,0 +1,192 @@
+#include "aida64_layout.h"
+#include <mutex>
+#include <string.h>
+
+static std::vector<AIDA64_LAYOUT_ITEM> publishedLayout;
+static volatile uint32_t publishedHash = 0;
+static std::mutex layoutMutex;
+
+// 默认布局, 项目与 aida64config/eng.rslcd 一致, 顺序按两列网格排列
+static const struct
+{
+    const char *id;
+    const char *label;
+    const char *unit;
+    uint8_t numeric;
+} defaultLayout[] = {
+    {"Simple1",  "CPU Usage",    "%",    1},
+    {"Simple2",  "CPU Temp",     "°C",   1},
+    {"Simple11", "GPU Usage",    "%",    1},
+    {"Simple5",  "GPU Temp",     "°C",   1},
+    {"Simple7",  "Memory Usage", "%",    1},
+    {"Simple3",  "CPU Clock",    "MHz",  1},
+    {"Simple8",  "Used Memory",  "MB",   1},
+    {"Simple4",  "CPU Power",    "W",    1},
+    {"Simple14", "GPU Memory",   "MB",   1},
+    {"Simple6",  "GPU Power",    "W",    1},
+    {"Simple9",  "Download",     "KB/s", 1},
+    {"Simple10", "Upload",       "KB/s", 1},
+    {"Simple12", "Local IP",     "",     0},
+    {"Simple13", "External IP",  "",     0},
+};
+
+static void copyTrimmed(char *dst, size_t size, const char *begin, const char *end)
+{
+    size_t len;
+
+    while (begin < end && *begin == ' ') begin++;
+    while (end > begin && end[-1] == ' ') end--;
+
+    len = end - begin;
+    if (len >= size) len = size - 1;
+
+    memcpy(dst, begin, len);
+    dst[len] = '\0';
+}
+
+static void makePrefix(AIDA64_LAYOUT_ITEM &item)
+{
+    // 解析SSE数据时去除了值中的空格, 前缀也需要同样处理
+    char *dst = item.prefix;
+    const char *src = item.label;
+
+    while (*src && dst < item.prefix + sizeof(item.prefix) - 1) {
+        if (*src != ' ') *dst++ = *src;
+        src++;
+    }
+    *dst = '\0';
+}
+
+// 从尾部反向查找最后一个数值 (允许包含 '.' 和 ':', 以覆盖IP和时间)
+static const char *findLastNumber(const char *start, const char *end, const char **numEnd)
+{
+    const char *tail = end;
+    const char *head;
+
+    while (tail > start && !isdigit((unsigned char)tail[-1])) tail--;
+    if (tail == start) {
+        *numEnd = end;
+        return NULL;
+    }
+
+    head = tail;
+    while (head > start && (isdigit((unsigned char)head[-1]) || head[-1] == '.' || head[-1] == ':')) head--;
+    while (!isdigit((unsigned char)*head)) head++;
+
+    *numEnd = tail;
+    return head;
+}
+
+void splitAida64Text(const char *text, AIDA64_LAYOUT_ITEM &item)
+{
+    const char *start = text;
+    const char *end;
+    const char *numStart;
+    const char *numEnd;
+    int dots = 0;
+    bool colon = false;
+
+    while (*start == '>' || *start == ' ') start++;
+    end = start + strlen(start);
+
+    numStart = findLastNumber(start, end, &numEnd);
+    if (numStart == NULL) {
+        copyTrimmed(item.label, sizeof(item.label), start, end);
+        item.unit[0] = '\0';
+        item.numeric = 0;
+    } else {
+        for (const char *p = numStart; p < numEnd; p++) {
+            if (*p == '.') dots++;
+            if (*p == ':') colon = true;
+        }
+
+        copyTrimmed(item.label, sizeof(item.label), start, numStart);
+        copyTrimmed(item.unit, sizeof(item.unit), numEnd, end);
+        item.numeric = (!colon && dots <= 1) ? 1 : 0;
+    }
+
+    makePrefix(item);
+}
+
+const char *findAida64Value(const char *text, const char *prefix)
+{
+    const char *start = text;
+    const char *numStart;
+    const char *numEnd;
+    size_t prefixLen = strlen(prefix);
+
+    while (*start == '>' || *start == ' ') start++;
+
+    if (prefixLen > 0 && strncmp(start, prefix, prefixLen) == 0) {
+        start += prefixLen;
+        while (*start == ' ') start++;
+        return start;
+    }
+
+    numStart = findLastNumber(start, start + strlen(start), &numEnd);
+    return numStart ? numStart : start;
+}
+
+uint32_t calcAida64LayoutHash(const std::vector<AIDA64_LAYOUT_ITEM> &layout)
+{
+    uint32_t hash = 2166136261u;
+
+    for (const auto &item : layout) {
+        const char *fields[] = {item.id, item.label, item.unit};
+        for (const char *field : fields) {
+            for (const char *p = field; *p; p++) {
+                hash ^= (uint8_t)*p;
+                hash *= 16777619u;
+            }
+            hash ^= '|';
+            hash *= 16777619u;
+        }
+    }
+
+    // 0 保留给"尚未发现布局"
+    return hash ? hash : 1;
+}
+
+void publishAida64Layout(const std::vector<AIDA64_LAYOUT_ITEM> &layout)
+{
+    uint32_t hash = calcAida64LayoutHash(layout);
+
+    if (hash == publishedHash) {
+        layoutPrintLog("Layout unchanged (hash %08x)\r\n", hash);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(layoutMutex);
+    publishedLayout = layout;
+    publishedHash = hash;
+
+    layoutPrintLog("Published layout with %u items (hash %08x)\r\n", (unsigned)layout.size(), hash);
+}
+
+uint32_t getAida64LayoutHash()
+{
+    return publishedHash;
+}
+
+uint32_t copyAida64Layout(std::vector<AIDA64_LAYOUT_ITEM> &layout)
+{
+    std::lock_guard<std::mutex> lock(layoutMutex);
+    layout = publishedLayout;
+    return publishedHash;
+}
+
+void getDefaultAida64Layout(std::vector<AIDA64_LAYOUT_ITEM> &layout)
+{
+    AIDA64_LAYOUT_ITEM item;
+
+    layout.clear();
+    for (const auto &def : defaultLayout) {
+        memset(&item, 0, sizeof(item));
+        strncpy(item.id, def.id, sizeof(item.id) - 1);
+        strncpy(item.label, def.label, sizeof(item.label) - 1);
+        strncpy(item.unit, def.unit, sizeof(item.unit) - 1);
+        item.numeric = def.numeric;
+        makePrefix(item);
+        layout.push_back(item);
+    }
+}
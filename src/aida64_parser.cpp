@@ -0,0 +1,227 @@
+#include "aida64_parser.h"
+#include <string.h>
+#include "metrics.h"
+#include "trace.h"
+#include "alloc_track.h"
+
+void aida64StreamReset(AIDA64_STREAM &stream)
+{
+    stream.length = 0;
+    stream.scan = 0;
+    stream.buffer[0] = '\0';
+}
+
+char *aida64StreamWritePtr(AIDA64_STREAM &stream, size_t *space)
+{
+    *space = sizeof(stream.buffer) - 1 - stream.length;
+    return stream.buffer + stream.length;
+}
+
+void aida64StreamCommit(AIDA64_STREAM &stream, size_t len)
+{
+    stream.length += len;
+    stream.buffer[stream.length] = '\0';
+}
+
+char *aida64StreamNextEvent(AIDA64_STREAM &stream)
+{
+    char *lineStart;
+    char *lineEnd;
+
+    while (1) {
+        lineStart = stream.buffer + stream.scan;
+        lineEnd = strchr(lineStart, '\n');
+        if (lineEnd == NULL) {
+            break;
+        }
+
+        *lineEnd = '\0';
+        stream.scan = lineEnd + 1 - stream.buffer;
+        if (strncmp(lineStart, "data:", 5) == 0) {
+            return lineStart;
+        }
+    }
+
+    // 不完整的行移到缓冲区开头, 等待后续数据
+    stream.length -= stream.scan;
+    memmove(stream.buffer, lineStart, stream.length + 1);
+    stream.scan = 0;
+
+    if (stream.length >= sizeof(stream.buffer) - 1) {
+        parserPrintLog("Frame exceeds %u bytes, dropped\n", (unsigned)(sizeof(stream.buffer) - 1));
+        metricsInc(METRIC_FRAMES_DROPPED);
+        aida64StreamReset(stream);
+    }
+    return NULL;
+}
+
+// 解码AIDA64页面中可能出现的少量HTML实体
+static void decodeHtmlText(const char *src, size_t len, char *dst, size_t size)
+{
+    static const struct { const char *name; const char *text; } entities[] = {
+        {"&nbsp;", " "}, {"&amp;", "&"}, {"&lt;", "<"}, {"&gt;", ">"}, {"&deg;", "°"},
+    };
+    const char *end = src + len;
+    size_t out = 0;
+
+    while (src < end && out < size - 1) {
+        bool decoded = false;
+
+        if (*src == '&') {
+            for (const auto &entity : entities) {
+                size_t nameLen = strlen(entity.name);
+                size_t textLen = strlen(entity.text);
+                if ((size_t)(end - src) >= nameLen && strncmp(src, entity.name, nameLen) == 0) {
+                    if (out + textLen < size) {
+                        memcpy(dst + out, entity.text, textLen);
+                        out += textLen;
+                    }
+                    src += nameLen;
+                    decoded = true;
+                    break;
+                }
+            }
+        }
+
+        if (!decoded) {
+            dst[out++] = *src++;
+        }
+    }
+
+    dst[out] = '\0';
+}
+
+void parseAida64HTML(const char *htmlData, std::vector<AIDA64_DATA> &dataList)
+{
+    /*
+     * 接收到的HTML有如下结构
+     * ...
+     * <body onload="MyOnLoad()">
+     * <div id="page0">
+     * <span id="xxx1" ...>XXX</span>
+     * <span id="xxx2" ...>XXX</span>
+     * ...
+     * <span id="xxxn" ...>XXX</span>
+     * </div>
+     * </body>
+     * ...
+     * 其中span标签的内容即是在AIDA64中设置的LCD项目，需要将id和内容提取出来，保存在dataList中
+     * 之后由布局发现拆分出标签和单位, 生成显示绑定表
+     * 页面可能有数KB, std::regex的回溯会占用大量任务栈, 因此这里直接用strstr扫描
+     */
+
+    AIDA64_DATA data = {0};
+    const char *pos = htmlData;
+
+    dataList.clear();
+
+    while ((pos = strstr(pos, "<span id=\"")) != NULL) {
+        const char *idStart = pos + 10;
+        const char *idEnd = strchr(idStart, '"');
+        if (idEnd == NULL) break;
+
+        const char *textStart = strchr(idEnd, '>');
+        if (textStart == NULL) break;
+        textStart++;
+
+        const char *textEnd = strstr(textStart, "</span>");
+        if (textEnd == NULL) break;
+
+        memset(&data, 0, sizeof(data));
+        size_t idLen = idEnd - idStart;
+        if (idLen >= sizeof(data.id)) idLen = sizeof(data.id) - 1;
+        memcpy(data.id, idStart, idLen);
+        decodeHtmlText(textStart, textEnd - textStart, data.val, sizeof(data.val));
+
+        if (data.id[0] != '\0') {
+            parserDebugLog("match: %s, %s\r\n", data.id, data.val);
+            dataList.push_back(data);
+        }
+
+        pos = textEnd + 7;
+    }
+
+    return;
+}
+
+void parseAida64Layout(const char *htmlData, std::vector<AIDA64_LAYOUT_ITEM> &layout)
+{
+    std::vector<AIDA64_DATA> spans;
+    AIDA64_LAYOUT_ITEM item;
+
+    parseAida64HTML(htmlData, spans);
+
+    layout.clear();
+    for (const auto &span : spans) {
+        memset(&item, 0, sizeof(item));
+        strncpy(item.id, span.id, sizeof(item.id) - 1);
+        splitAida64Text(span.val, item);
+        layout.push_back(item);
+    }
+}
+
+void parseAida64Data(char *src, std::vector<AIDA64_DATA> &dataList)
+{
+    /* 
+     * AIDA64会回复以下格式的响应体:
+     * data: Page0|{|}Simple2|2:55:48{|}Simple4|3%{|}Simple5|1097MHz{|}Simple6|40°C{|}...
+     * 需要将数据从字符串中提取出来
+     */
+    
+    TRACE_SCOPE(TRACE_PARSE);
+    ALLOC_STAGE(STAGE_PARSE);
+    AIDA64_DATA data = {0};
+    const char *pos;
+    const char *delim;
+
+    parserDebugLog("SSE Data received:\r\n%s\r\n", src);
+
+    // 首先检查是否包含 "data:" 开头的SSE数据
+    pos = strstr(src, "data:");
+    if (pos == NULL) {
+        return; // 不是有效的SSE数据
+    }
+    pos += 5; // 跳过 "data:"
+
+    // 清空现有数据列表以准备新数据, 容量保留, 稳定后不再分配内存
+    dataList.clear();
+
+    // 解析数据格式：Page0|{|}Simple2|2:55:48{|}Simple4|3%{|}...
+    // 直接在原缓冲区上切分, 不构造临时字符串
+    bool skipFirst = true; // 跳过第一个 Page0|{|}
+
+    while ((delim = strstr(pos, "{|}")) != NULL) {
+        // 这一段：例如 "Simple2|2:55:48"
+        const char *pipe = (const char *)memchr(pos, '|', delim - pos);
+
+        if (!skipFirst && pipe != NULL) {
+            size_t idLen = pipe - pos;
+            size_t valLen = 0;
+
+            memset(&data, 0, sizeof(data));
+            if (idLen > sizeof(data.id) - 1) {
+                idLen = sizeof(data.id) - 1;
+            }
+            memcpy(data.id, pos, idLen);
+
+            // 值以 '>' 开头, 移除其中的空格
+            data.val[valLen++] = '>';
+            for (const char *c = pipe + 1; c < delim && valLen < sizeof(data.val) - 1; c++) {
+                if (*c != ' ') {
+                    data.val[valLen++] = *c;
+                }
+            }
+
+            // 将解析的数据添加到列表
+            dataList.push_back(data);
+
+            parserDebugLog("Parsed: ID=%s, Value=%s\n", data.id, data.val);
+        }
+
+        skipFirst = false;
+        pos = delim + 3; // 跳过 {|}
+    }
+
+    parserDebugLog("Total parsed items: %u\n", (unsigned)dataList.size());
+    return;
+}
@@ -0,0 +1,313 @@
+#include "alloc_track.h"
+
+#if ALLOC_TRACK
+
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#else
+#include <pthread.h>
+#endif
+
+// 同时处于管线阶段中的任务数 (HTTP任务和显示任务)
+#define ALLOC_TASK_SLOTS 4
+
+// 阶段标记按任务保存, 分配钩子里只做一次线性查找
+typedef struct
+{
+    std::atomic<void *> task;
+    std::atomic<uint8_t> stage;
+} ALLOC_TASK_SLOT;
+
+static ALLOC_TASK_SLOT slots[ALLOC_TASK_SLOTS];
+
+// 下标STAGE_MAX为管线之外的分配
+static std::atomic<uint32_t> counts[STAGE_MAX + 1];
+static std::atomic<uint32_t> steadyCounts[STAGE_MAX + 1];
+// 其中来自LVGL内存池的分配 (lv_mem_alloc/lv_mem_realloc)
+static std::atomic<uint32_t> lvglCounts[STAGE_MAX + 1];
+static std::atomic<uint32_t> failedCount(0);
+static std::atomic<uint32_t> warmupFrames(0);
+static std::atomic<bool> steady(false);
+
+// 上次allocCheck输出时的值
+static uint32_t reportedSteady[STAGE_MAX];
+static uint32_t reportedFailed = 0;
+
+static void *currentTask()
+{
+#ifdef ARDUINO
+    // 调度器启动之前 (全局构造等) 没有当前任务
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        return NULL;
+    }
+    return xTaskGetCurrentTaskHandle();
+#else
+    return (void *)(uintptr_t)pthread_self();
+#endif
+}
+
+static int findSlot(void *task)
+{
+    for (int i = 0; i < ALLOC_TASK_SLOTS; i++) {
+        if (slots[i].task.load(std::memory_order_relaxed) == task) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void allocRecord(bool lvgl = false)
+{
+    void *task = currentTask();
+    int slot = task ? findSlot(task) : -1;
+    uint8_t stage = slot >= 0 ? slots[slot].stage.load(std::memory_order_relaxed) : STAGE_MAX;
+
+    counts[stage].fetch_add(1, std::memory_order_relaxed);
+    if (lvgl) {
+        lvglCounts[stage].fetch_add(1, std::memory_order_relaxed);
+    }
+    if (stage == STAGE_MAX || !steady.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    steadyCounts[stage].fetch_add(1, std::memory_order_relaxed);
+#if ALLOC_TRACK_STRICT
+    // 在分配点中止, 回溯直接指向违规的调用
+    if (ALLOC_STRICT_STAGES & (1u << stage)) {
+        abort();
+    }
+#endif
+}
+
+PIPELINE_STAGE allocSetStage(PIPELINE_STAGE stage)
+{
+    void *task = currentTask();
+    int slot = findSlot(task);
+
+    PIPELINE_STAGE prev = STAGE_MAX;
+
+    if (slot >= 0) {
+        prev = (PIPELINE_STAGE)slots[slot].stage.load(std::memory_order_relaxed);
+    }
+
+    // 第一次进入阶段的任务占用一个空位
+    for (int i = 0; slot < 0 && i < ALLOC_TASK_SLOTS; i++) {
+        void *expected = NULL;
+        if (slots[i].task.compare_exchange_strong(expected, task)) {
+            slot = i;
+        }
+    }
+    if (slot < 0) {
+        return STAGE_MAX;
+    }
+
+    slots[slot].stage.store(stage, std::memory_order_relaxed);
+    return prev;
+}
+
+void allocOnFrame()
+{
+    if (!steady.load(std::memory_order_relaxed) &&
+        warmupFrames.fetch_add(1, std::memory_order_relaxed) + 1 >= ALLOC_WARMUP_FRAMES) {
+        steady.store(true, std::memory_order_relaxed);
+    }
+}
+
+void allocRestartWarmup()
+{
+    steady.store(false, std::memory_order_relaxed);
+    warmupFrames.store(0, std::memory_order_relaxed);
+}
+
+bool allocIsSteady()
+{
+    return steady.load(std::memory_order_relaxed);
+}
+
+uint32_t allocGetCount(PIPELINE_STAGE stage)
+{
+    return counts[stage].load(std::memory_order_relaxed);
+}
+
+uint32_t allocGetLvglCount(PIPELINE_STAGE stage)
+{
+    return lvglCounts[stage].load(std::memory_order_relaxed);
+}
+
+uint32_t allocGetSteadyCount(PIPELINE_STAGE stage)
+{
+    return steadyCounts[stage].load(std::memory_order_relaxed);
+}
+
+uint32_t allocGetViolations()
+{
+    uint32_t total = 0;
+
+    for (int stage = 0; stage < STAGE_MAX; stage++) {
+        if (ALLOC_STRICT_STAGES & (1u << stage)) {
+            total += steadyCounts[stage].load(std::memory_order_relaxed);
+        }
+    }
+    return total;
+}
+
+uint32_t allocGetFailed()
+{
+    return failedCount.load(std::memory_order_relaxed);
+}
+
+void allocCheck()
+{
+    for (int stage = 0; stage < STAGE_MAX; stage++) {
+        uint32_t count = allocGetSteadyCount((PIPELINE_STAGE)stage);
+        if (count != reportedSteady[stage]) {
+            allocPrintLog("%u steady-state allocations in %s%s\r\n", count - reportedSteady[stage],
+                          metricsStageName((PIPELINE_STAGE)stage),
+                          (ALLOC_STRICT_STAGES & (1u << stage)) ? "" : " (not enforced)");
+            reportedSteady[stage] = count;
+        }
+    }
+
+    uint32_t failed = allocGetFailed();
+    if (failed != reportedFailed) {
+        allocPrintLog("%u allocations failed\r\n", failed - reportedFailed);
+        reportedFailed = failed;
+    }
+}
+
+#ifdef ARDUINO
+// heap_caps在分配失败时回调, 不能在这里输出日志
+static void allocFailedCallback(size_t size, uint32_t caps, const char *function_name)
+{
+    failedCount.fetch_add(1, std::memory_order_relaxed);
+}
+#endif
+
+void allocTrackBegin()
+{
+#ifdef ARDUINO
+    heap_caps_register_failed_alloc_callback(allocFailedCallback);
+#endif
+    allocPrintLog("Tracking heap allocations, steady state after %d frames%s\r\n",
+                  ALLOC_WARMUP_FRAMES, ALLOC_TRACK_STRICT ? " (strict)" : "");
+}
+
+/*
+ * 分配钩子
+ * ESP-IDF开启 CONFIG_HEAP_USE_HOOKS 时由heap_caps回调计数, 可以覆盖直接调用heap_caps_malloc的组件;
+ * 否则由链接器包装的malloc系列计数
+ */
+#if defined(ARDUINO) && defined(CONFIG_HEAP_USE_HOOKS)
+#define ALLOC_COUNT_IN_WRAP 0
+
+extern "C" void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    allocRecord();
+}
+#else
+#define ALLOC_COUNT_IN_WRAP 1
+#endif
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    if (ALLOC_COUNT_IN_WRAP) {
+        allocRecord();
+    }
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+    if (ALLOC_COUNT_IN_WRAP) {
+        allocRecord();
+    }
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    if (ALLOC_COUNT_IN_WRAP) {
+        allocRecord();
+    }
+    return __real_realloc(ptr, size);
+}
+
+/*
+ * LV_MEM_CUSTOM为0时LVGL从自己的内存池分配 (标签文字、动画、样式等), 不经过malloc,
+ * 单独包装池的入口后与堆分配一起计数. lv_mem.c内部的调用 (lv_mem_buf_get的缓冲区增长) 不经过链接器, 不计数
+ */
+void *__real_lv_mem_alloc(size_t size);
+void *__real_lv_mem_realloc(void *ptr, size_t size);
+
+void *__wrap_lv_mem_alloc(size_t size)
+{
+    allocRecord(true);
+    return __real_lv_mem_alloc(size);
+}
+
+void *__wrap_lv_mem_realloc(void *ptr, size_t size)
+{
+    allocRecord(true);
+    return __real_lv_mem_realloc(ptr, size);
+}
+}
+
+// 主机上的libstdc++是动态库, 其中的operator new不经过包装, 在这里替换为malloc
+void *operator new(size_t size)
+{
+    void *ptr = malloc(size ? size : 1);
+    if (ptr == NULL) {
+#if __cpp_exceptions
+        throw std::bad_alloc();
+#else
+        abort();
+#endif
+    }
+    return ptr;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept
+{
+    return malloc(size ? size : 1);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept
+{
+    return malloc(size ? size : 1);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t size) noexcept
+{
+    free(ptr);
+}
+
+#endif
@@ -0,0 +1,953 @@
+#ifndef ARDUINO
+
+/*
+ * env:companion 入口
+ * 中继: 对一台PC只保持一个AIDA64的SSE连接 (或回放录制的数据作为替身), 再分发给任意数量的面板.
+ * 单线程epoll循环; 每帧只编码一次, 所有连接共享同一块帧缓冲区, 按连接排队并用writev发送.
+ * 多台PC各运行一个进程 (端口不同).
+ *
+ * 用法: aida64_companion [-c] [-k frames] [-p port] [-s port] [-m group[:port]] [-q bytes] [-o file]
+ *                        [-l layout.html] [-r ms] <-a host[:port] | capture | ->
+ *   -a  连接AIDA64 (默认端口80), 布局取自其页面, 断开后自动重连
+ *   -c  每帧附加CRC
+ *   -k  关键帧间隔 (帧数, 默认30)
+ *   -p  二进制协议的面板端口 (默认 COMPANION_PORT), 0为不监听
+ *   -s  SSE端口: 未修改的面板把 HTTP_HOST/HTTP_PORT 指向这里, 页面和SSE都由中继提供
+ *   -m  以UDP组播发送二进制帧 (默认端口 COMPANION_PORT), 面板定义 COMPANION_MULTICAST 接收
+ *   -q  每个连接的排队上限 (字节, 默认32768), 超出时丢弃积压的帧
+ *   -o  同时写入文件, "-" 为标准输出
+ *   -l  回放时使用的布局页面, 不指定时使用默认布局
+ *   -r  回放时的帧间隔 (毫秒, 默认1000, 0为不限速)
+ */
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "hal.h"
+#include "aida64_binary.h"
+#include "aida64_parser.h"
+
+#define COMPANION_KEYFRAME_INTERVAL 30
+#define COMPANION_REPLAY_MS 1000
+#define COMPANION_RETRY_MS 10000
+#define COMPANION_QUEUE_LIMIT 32768
+// 连接的内核发送缓冲区: 保持较小, 积压留在中继的队列里按帧丢弃, 而不是在内核里攒下大量过时的帧
+#define COMPANION_SNDBUF 8192
+// 获取页面和建立SSE连接时的超时, 期间事件循环暂停
+#define COMPANION_CONNECT_TIMEOUT_MS 3000
+#define COMPANION_REQUEST_SIZE 512
+#define COMPANION_MAX_EVENTS 64
+#define COMPANION_MAX_IOV 64
+
+// 共享帧: 编码一次, 由所有连接的队列引用, 最后一个引用释放时回收
+typedef struct
+{
+    std::vector<uint8_t> data;
+    bool keyframe;
+} RELAY_FRAME;
+
+typedef std::shared_ptr<const RELAY_FRAME> RELAY_FRAME_REF;
+
+enum ENDPOINT_KIND {
+    ENDPOINT_PANEL_LISTENER,
+    ENDPOINT_SSE_LISTENER,
+    ENDPOINT_UPSTREAM,
+    ENDPOINT_PANEL,         // 二进制协议连接
+    ENDPOINT_SSE,           // HTTP连接, 请求 /sse 后转为事件流
+};
+
+typedef struct
+{
+    ENDPOINT_KIND kind;
+    int fd;
+    std::deque<RELAY_FRAME_REF> queue;
+    size_t offset;          // 队首帧已发送的字节数
+    size_t queued;          // 队列中未发送的字节数
+    bool writable;          // 未注册EPOLLOUT, 可以直接写
+    bool needKeyframe;      // 丢过帧, 下一帧换成单独的关键帧
+    bool streaming;         // SSE连接已开始接收事件
+    bool closeWhenDrained;  // 页面响应发送完后关闭
+    uint32_t dropped;
+    char request[COMPANION_REQUEST_SIZE];
+    size_t requestLen;
+} ENDPOINT;
+
+static int epollFd = -1;
+static ENDPOINT *panelListener = NULL;
+static ENDPOINT *sseListener = NULL;
+static ENDPOINT *upstream = NULL;
+static std::vector<ENDPOINT *> clients;
+static std::vector<ENDPOINT *> closedEndpoints;     // 本轮事件处理完后释放
+
+static AIDA64_STREAM stream;
+static AIDA64_BIN_ENCODER encoder;
+static std::vector<AIDA64_DATA> frame;
+static uint8_t packet[AIDA64_BIN_MAX_FRAME];
+
+static RELAY_FRAME_REF layoutFrame;     // 当前布局帧, 新连接和补发时使用
+static RELAY_FRAME_REF catchupFrame;    // 按当前状态编码的关键帧, 每个数值帧之后失效
+static RELAY_FRAME_REF lastEvent;       // 最近一个SSE事件, SSE新连接立即收到
+static RELAY_FRAME_REF pageResponse;    // GET / 的完整响应
+static RELAY_FRAME_REF sseHeader;
+
+static const char *aidaHost = NULL;
+static int aidaPort = 80;
+static bool useCrc = false;
+static uint32_t keyframeInterval = COMPANION_KEYFRAME_INTERVAL;
+static uint32_t replayMs = COMPANION_REPLAY_MS;
+static size_t queueLimit = COMPANION_QUEUE_LIMIT;
+
+static int fileFd = -1;
+static int multicastFd = -1;
+static struct sockaddr_in multicastAddr;
+static int replayFd = -1;
+static uint64_t nextReplayMs = 0;
+static uint64_t reconnectMs = 0;
+
+static uint32_t framesIn = 0;
+static uint64_t bytesIn = 0;
+static uint64_t bytesOut = 0;
+static uint32_t framesDropped = 0;
+static uint32_t catchups = 0;
+
+static uint64_t nowMs()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static RELAY_FRAME_REF makeFrame(const void *data, size_t len, bool keyframe)
+{
+    std::shared_ptr<RELAY_FRAME> relayFrame = std::make_shared<RELAY_FRAME>();
+
+    relayFrame->data.assign((const uint8_t *)data, (const uint8_t *)data + len);
+    relayFrame->keyframe = keyframe;
+    return relayFrame;
+}
+
+static void setNonBlocking(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+static int connectTcp(const char *host, int port)
+{
+    struct addrinfo hints;
+    struct addrinfo *result;
+    struct timeval timeout = {COMPANION_CONNECT_TIMEOUT_MS / 1000, (COMPANION_CONNECT_TIMEOUT_MS % 1000) * 1000};
+    char service[8];
+    int fd = -1;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    snprintf(service, sizeof(service), "%d", port);
+    if (getaddrinfo(host, service, &hints, &result) != 0) {
+        fprintf(stderr, "cannot resolve %s\n", host);
+        return -1;
+    }
+
+    for (struct addrinfo *ai = result; ai != NULL; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) {
+            continue;
+        }
+        // Linux上SO_SNDTIMEO同样限制connect, 不可达的主机不会长时间阻塞事件循环
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(result);
+    return fd;
+}
+
+static bool writeAll(int fd, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        len -= n;
+    }
+    return true;
+}
+
+static int httpGet(const char *path, const char *accept, bool keepAlive)
+{
+    char request[256];
+    int fd = connectTcp(aidaHost, aidaPort);
+
+    if (fd < 0) {
+        return -1;
+    }
+    snprintf(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: %s\r\nAccept: %s\r\nCache-Control: no-cache\r\n%s\r\n",
+             path, aidaHost, accept, keepAlive ? "" : "Connection: close\r\n");
+    if (send(fd, request, strlen(request), MSG_NOSIGNAL) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static void readAll(int fd, std::vector<char> &data)
+{
+    char chunk[1024];
+    ssize_t len;
+
+    while ((len = read(fd, chunk, sizeof(chunk))) > 0) {
+        data.insert(data.end(), chunk, chunk + len);
+    }
+}
+
+// 响应头不含span, 整体交给页面解析即可
+static bool parseLayoutPage(std::vector<char> page, std::vector<AIDA64_LAYOUT_ITEM> &layout)
+{
+    page.push_back('\0');
+    parseAida64Layout(page.data(), layout);
+    return !layout.empty();
+}
+
+// 本地的布局页面加上响应头, 供SSE面板发现布局
+static void setPageBody(const std::vector<char> &body)
+{
+    char header[160];
+    int len = snprintf(header, sizeof(header),
+                       "HTTP/1.1 200 OK\r\nContent-Type: text/html\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n",
+                       body.size());
+    std::vector<char> response(header, header + len);
+
+    response.insert(response.end(), body.begin(), body.end());
+    pageResponse = makeFrame(response.data(), response.size(), false);
+}
+
+/*
+ * 连接管理
+ */
+static void watch(ENDPOINT *endpoint, uint32_t events, int op)
+{
+    struct epoll_event event;
+
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.ptr = endpoint;
+    epoll_ctl(epollFd, op, endpoint->fd, &event);
+}
+
+static ENDPOINT *addEndpoint(ENDPOINT_KIND kind, int fd)
+{
+    ENDPOINT *endpoint = new ENDPOINT();
+
+    endpoint->kind = kind;
+    endpoint->fd = fd;
+    endpoint->writable = true;
+    watch(endpoint, EPOLLIN, EPOLL_CTL_ADD);
+    return endpoint;
+}
+
+static void closeEndpoint(ENDPOINT *endpoint)
+{
+    if (endpoint->fd < 0) {
+        return;
+    }
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, endpoint->fd, NULL);
+    close(endpoint->fd);
+    endpoint->fd = -1;
+    endpoint->queue.clear();
+
+    if (endpoint->kind == ENDPOINT_PANEL || endpoint->kind == ENDPOINT_SSE) {
+        for (size_t i = 0; i < clients.size(); i++) {
+            if (clients[i] == endpoint) {
+                clients.erase(clients.begin() + i);
+                break;
+            }
+        }
+        if (endpoint->kind == ENDPOINT_PANEL || endpoint->streaming) {
+            fprintf(stderr, "%s client disconnected (%u frames dropped), %zu clients\n",
+                    endpoint->kind == ENDPOINT_PANEL ? "panel" : "SSE", endpoint->dropped, clients.size());
+        }
+    }
+    // 同一批epoll事件中可能还有指向它的事件, 延后释放
+    closedEndpoints.push_back(endpoint);
+}
+
+// 尽量发出队列中的数据, 写不完时注册EPOLLOUT等待
+static void flushEndpoint(ENDPOINT *endpoint)
+{
+    struct iovec iov[COMPANION_MAX_IOV];
+
+    while (!endpoint->queue.empty()) {
+        int count = 0;
+        for (const auto &queued : endpoint->queue) {
+            if (count == COMPANION_MAX_IOV) {
+                break;
+            }
+            size_t skip = count == 0 ? endpoint->offset : 0;
+            iov[count].iov_base = (void *)(queued->data.data() + skip);
+            iov[count].iov_len = queued->data.size() - skip;
+            count++;
+        }
+
+        ssize_t n = writev(endpoint->fd, iov, count);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (n <= 0) {
+            closeEndpoint(endpoint);
+            return;
+        }
+
+        bytesOut += n;
+        endpoint->queued -= n;
+        while (n > 0) {
+            size_t left = endpoint->queue.front()->data.size() - endpoint->offset;
+            if ((size_t)n < left) {
+                endpoint->offset += n;
+                break;
+            }
+            n -= left;
+            endpoint->offset = 0;
+            endpoint->queue.pop_front();
+        }
+    }
+
+    bool drained = endpoint->queue.empty();
+    if (drained && endpoint->closeWhenDrained) {
+        closeEndpoint(endpoint);
+        return;
+    }
+    if (drained != endpoint->writable) {
+        endpoint->writable = drained;
+        watch(endpoint, drained ? EPOLLIN : EPOLLIN | EPOLLOUT, EPOLL_CTL_MOD);
+    }
+}
+
+static void enqueue(ENDPOINT *endpoint, const RELAY_FRAME_REF &relayFrame)
+{
+    endpoint->queue.push_back(relayFrame);
+    endpoint->queued += relayFrame->data.size();
+}
+
+// 积压超出上限: 丢弃未开始发送的帧, 已发出一部分的帧必须发完, 否则接收端失去帧边界
+static bool dropBacklog(ENDPOINT *endpoint, size_t incoming)
+{
+    if (endpoint->queued + incoming <= queueLimit) {
+        return false;
+    }
+
+    size_t keep = endpoint->offset > 0 ? 1 : 0;
+    while (endpoint->queue.size() > keep) {
+        endpoint->queued -= endpoint->queue.back()->data.size();
+        endpoint->queue.pop_back();
+        endpoint->dropped++;
+        framesDropped++;
+    }
+    return true;
+}
+
+static RELAY_FRAME_REF currentKeyframe()
+{
+    if (!catchupFrame) {
+        size_t len = aida64BinaryEncodeKeyframe(encoder, packet, sizeof(packet));
+        catchupFrame = makeFrame(packet, len, true);
+    }
+    return catchupFrame;
+}
+
+// 二进制连接从布局和按当前状态编码的关键帧开始; 布局未变化时面板不会重建
+static void sendCatchup(ENDPOINT *endpoint)
+{
+    if (layoutFrame) {
+        enqueue(endpoint, layoutFrame);
+    }
+    if (encoder.frames > 0) {
+        enqueue(endpoint, currentKeyframe());
+        catchups++;
+    }
+    endpoint->needKeyframe = false;
+}
+
+static void acceptClients(ENDPOINT *listener)
+{
+    int one = 1;
+    int sndbuf = COMPANION_SNDBUF;
+    int fd;
+
+    while ((fd = accept(listener->fd, NULL, NULL)) >= 0) {
+        setNonBlocking(fd);
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+
+        if (listener->kind == ENDPOINT_PANEL_LISTENER) {
+            ENDPOINT *panel = addEndpoint(ENDPOINT_PANEL, fd);
+            clients.push_back(panel);
+            fprintf(stderr, "panel connected, %zu clients\n", clients.size());
+            sendCatchup(panel);
+            flushEndpoint(panel);
+        } else {
+            // 等待HTTP请求, 收到 /sse 之后才加入分发
+            addEndpoint(ENDPOINT_SSE, fd);
+        }
+    }
+}
+
+// SSE端口上的HTTP请求: "/" 返回缓存的页面, "/sse" 开始事件流
+static void handleRequest(ENDPOINT *endpoint)
+{
+    static const char notFound[] = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    ssize_t n = recv(endpoint->fd, endpoint->request + endpoint->requestLen,
+                     sizeof(endpoint->request) - 1 - endpoint->requestLen, 0);
+
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return;
+    }
+    if (n <= 0) {
+        closeEndpoint(endpoint);
+        return;
+    }
+    // 请求之后的数据忽略
+    if (endpoint->streaming || endpoint->closeWhenDrained) {
+        return;
+    }
+    endpoint->requestLen += n;
+    endpoint->request[endpoint->requestLen] = '\0';
+
+    if (strstr(endpoint->request, "\r\n\r\n") == NULL) {
+        if (endpoint->requestLen >= sizeof(endpoint->request) - 1) {
+            closeEndpoint(endpoint);
+        }
+        return;
+    }
+
+    char path[64] = "";
+    sscanf(endpoint->request, "GET %63s", path);
+    endpoint->requestLen = 0;
+
+    if (strcmp(path, "/sse") == 0) {
+        endpoint->streaming = true;
+        clients.push_back(endpoint);
+        fprintf(stderr, "SSE client connected, %zu clients\n", clients.size());
+        enqueue(endpoint, sseHeader);
+        if (lastEvent) {
+            enqueue(endpoint, lastEvent);
+        }
+    } else {
+        endpoint->closeWhenDrained = true;
+        if (strcmp(path, "/") == 0 && pageResponse) {
+            enqueue(endpoint, pageResponse);
+        } else {
+            enqueue(endpoint, makeFrame(notFound, sizeof(notFound) - 1, false));
+        }
+    }
+    flushEndpoint(endpoint);
+}
+
+/*
+ * 分发
+ */
+static void multicastFrame(const RELAY_FRAME_REF &relayFrame)
+{
+    sendto(multicastFd, relayFrame->data.data(), relayFrame->data.size(), 0,
+           (struct sockaddr *)&multicastAddr, sizeof(multicastAddr));
+}
+
+static void broadcastBinary(const RELAY_FRAME_REF &relayFrame)
+{
+    if (fileFd >= 0 && !writeAll(fileFd, relayFrame->data.data(), relayFrame->data.size())) {
+        perror("write");
+        fileFd = -1;
+    }
+    if (multicastFd >= 0) {
+        // 每个数据报一帧; 组播没有连接, 关键帧之前重发布局, 中途加入的面板从这里开始
+        if (relayFrame->keyframe && layoutFrame) {
+            multicastFrame(layoutFrame);
+        }
+        multicastFrame(relayFrame);
+    }
+
+    std::vector<ENDPOINT *> targets(clients);
+    for (ENDPOINT *client : targets) {
+        if (client->kind != ENDPOINT_PANEL) {
+            continue;
+        }
+        if (dropBacklog(client, relayFrame->data.size())) {
+            client->needKeyframe = true;
+        }
+        if (client->needKeyframe && !relayFrame->keyframe) {
+            sendCatchup(client);
+        } else {
+            enqueue(client, relayFrame);
+            client->needKeyframe = false;
+        }
+        if (client->writable) {
+            flushEndpoint(client);
+        }
+    }
+}
+
+static void broadcastEvent(const RELAY_FRAME_REF &relayFrame)
+{
+    std::vector<ENDPOINT *> targets(clients);
+
+    for (ENDPOINT *client : targets) {
+        if (client->kind != ENDPOINT_SSE) {
+            continue;
+        }
+        // SSE事件是完整的帧, 丢弃积压即可
+        dropBacklog(client, relayFrame->data.size());
+        enqueue(client, relayFrame);
+        if (client->writable) {
+            flushEndpoint(client);
+        }
+    }
+}
+
+// 布局变化或首次设置时重新初始化编码器并通知面板
+static void setLayout(const std::vector<AIDA64_LAYOUT_ITEM> &layout)
+{
+    if (!encoder.layout.empty() && calcAida64LayoutHash(layout) == calcAida64LayoutHash(encoder.layout)) {
+        return;
+    }
+    aida64BinaryEncoderInit(encoder, layout, keyframeInterval, useCrc);
+    fprintf(stderr, "layout: %zu items\n", encoder.layout.size());
+
+    size_t len = aida64BinaryEncodeLayout(encoder, packet, sizeof(packet));
+    layoutFrame = makeFrame(packet, len, false);
+    catchupFrame.reset();
+    lastEvent.reset();
+
+    if (fileFd >= 0 && !writeAll(fileFd, packet, len)) {
+        perror("write");
+        fileFd = -1;
+    }
+
+    std::vector<ENDPOINT *> targets(clients);
+    for (ENDPOINT *client : targets) {
+        if (client->kind == ENDPOINT_PANEL) {
+            enqueue(client, layoutFrame);
+            flushEndpoint(client);
+        } else {
+            // SSE面板只在连接前获取页面, 断开后重新发现布局
+            closeEndpoint(client);
+        }
+    }
+}
+
+static void handleEvent(char *event)
+{
+    std::shared_ptr<RELAY_FRAME> text = std::make_shared<RELAY_FRAME>();
+    size_t len = strlen(event);
+
+    // SSE面板收到与AIDA64相同的事件文本
+    bytesIn += len + 1;
+    text->data.reserve(len + 2);
+    text->data.assign(event, event + len);
+    text->data.push_back('\n');
+    text->data.push_back('\n');
+    text->keyframe = false;
+    lastEvent = text;
+    broadcastEvent(lastEvent);
+
+    parseAida64Data(event, frame);
+    if (frame.empty()) {
+        return;
+    }
+
+    len = aida64BinaryEncodeData(encoder, frame, packet, sizeof(packet));
+    catchupFrame.reset();
+    if (len == 0) {
+        fprintf(stderr, "frame does not fit in %zu bytes\n", sizeof(packet));
+        return;
+    }
+    framesIn++;
+    broadcastBinary(makeFrame(packet, len, packet[2] == AIDA64_BIN_KEYFRAME));
+}
+
+/*
+ * 数据来源
+ */
+static void closeUpstream()
+{
+    if (upstream != NULL) {
+        closeEndpoint(upstream);
+        upstream = NULL;
+    }
+    reconnectMs = nowMs() + COMPANION_RETRY_MS;
+    fprintf(stderr, "AIDA64 connection ended, retrying in %d seconds\n", COMPANION_RETRY_MS / 1000);
+}
+
+static void connectUpstream()
+{
+    std::vector<AIDA64_LAYOUT_ITEM> layout;
+    std::vector<char> page;
+
+    // 每次连接前重新获取页面, 布局变化时通知面板
+    int fd = httpGet("/", "text/html", false);
+    if (fd >= 0) {
+        readAll(fd, page);
+        close(fd);
+    }
+    if (!page.empty()) {
+        // AIDA64的响应原样缓存, SSE面板的布局发现得到与直连相同的结果
+        pageResponse = makeFrame(page.data(), page.size(), false);
+    }
+    if (parseLayoutPage(page, layout)) {
+        setLayout(layout);
+    } else if (encoder.layout.empty()) {
+        getDefaultAida64Layout(layout);
+        setLayout(layout);
+    }
+
+    fd = httpGet("/sse", "text/event-stream", true);
+    if (fd < 0) {
+        closeUpstream();
+        return;
+    }
+    setNonBlocking(fd);
+    aida64StreamReset(stream);
+    upstream = addEndpoint(ENDPOINT_UPSTREAM, fd);
+    fprintf(stderr, "subscribed to %s:%d\n", aidaHost, aidaPort);
+}
+
+static void readUpstream()
+{
+    while (upstream != NULL) {
+        size_t space;
+        char *writePtr = aida64StreamWritePtr(stream, &space);
+        ssize_t len = recv(upstream->fd, writePtr, space, 0);
+        if (len < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return;
+        }
+        if (len <= 0) {
+            closeUpstream();
+            return;
+        }
+        aida64StreamCommit(stream, len);
+
+        char *event;
+        while ((event = aida64StreamNextEvent(stream)) != NULL) {
+            handleEvent(event);
+        }
+    }
+}
+
+// 回放: 普通文件不能加入epoll, 按帧间隔同步读取, 每次取出一个事件
+static bool replayNext()
+{
+    while (1) {
+        char *event = aida64StreamNextEvent(stream);
+        if (event != NULL) {
+            handleEvent(event);
+            return true;
+        }
+
+        size_t space;
+        char *writePtr = aida64StreamWritePtr(stream, &space);
+        int len = halRecv(replayFd, writePtr, space);
+        if (len <= 0) {
+            return false;
+        }
+        aida64StreamCommit(stream, len);
+    }
+}
+
+static bool clientsDrained()
+{
+    for (ENDPOINT *client : clients) {
+        if (!client->queue.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static ENDPOINT *openListener(ENDPOINT_KIND kind, int port)
+{
+    struct sockaddr_in addr;
+    int one = 1;
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (fd < 0) {
+        return NULL;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(port);
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0) {
+        close(fd);
+        return NULL;
+    }
+    setNonBlocking(fd);
+    return addEndpoint(kind, fd);
+}
+
+static bool openMulticast(char *group)
+{
+    unsigned char ttl = 1;
+    int port = COMPANION_PORT;
+    char *colon = strrchr(group, ':');
+
+    if (colon != NULL) {
+        *colon = '\0';
+        port = atoi(colon + 1);
+    }
+    memset(&multicastAddr, 0, sizeof(multicastAddr));
+    multicastAddr.sin_family = AF_INET;
+    multicastAddr.sin_port = htons(port);
+    if (inet_pton(AF_INET, group, &multicastAddr.sin_addr) != 1 || !IN_MULTICAST(ntohl(multicastAddr.sin_addr.s_addr))) {
+        fprintf(stderr, "%s is not a multicast group\n", group);
+        return false;
+    }
+
+    multicastFd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (multicastFd < 0) {
+        return false;
+    }
+    // 只在本网段内
+    setsockopt(multicastFd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    fprintf(stderr, "multicasting to %s:%d\n", group, port);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<AIDA64_LAYOUT_ITEM> layout;
+    const char *layoutPath = NULL;
+    const char *outPath = NULL;
+    char *multicastGroup = NULL;
+    int panelPort = -1;
+    int ssePort = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "a:ck:l:m:o:p:q:r:s:")) != -1) {
+        switch (opt) {
+            case 'a': aidaHost = optarg; break;
+            case 'c': useCrc = true; break;
+            case 'k': keyframeInterval = atoi(optarg); break;
+            case 'l': layoutPath = optarg; break;
+            case 'm': multicastGroup = optarg; break;
+            case 'o': outPath = optarg; break;
+            case 'p': panelPort = atoi(optarg); break;
+            case 'q': queueLimit = atoi(optarg); break;
+            case 'r': replayMs = atoi(optarg); break;
+            case 's': ssePort = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: %s [-c] [-k frames] [-p port] [-s port] [-m group[:port]] [-q bytes] [-o file] "
+                                "[-l layout.html] [-r ms] <-a host[:port] | capture | ->\n", argv[0]);
+                return 2;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (aidaHost == NULL && argc < 1) {
+        fprintf(stderr, "missing AIDA64 host or capture file\n");
+        return 2;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    logBegin();
+
+    epollFd = epoll_create1(0);
+    if (epollFd < 0) {
+        perror("epoll_create1");
+        return 1;
+    }
+
+    static const char header[] = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n"
+                                 "Connection: keep-alive\r\n\r\n";
+    sseHeader = makeFrame(header, sizeof(header) - 1, false);
+
+    if (outPath) {
+        fileFd = strcmp(outPath, "-") == 0 ? STDOUT_FILENO : open(outPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fileFd < 0) {
+            perror(outPath);
+            return 1;
+        }
+    }
+    // 只写文件时默认不占用端口
+    if (panelPort < 0) {
+        panelPort = outPath ? 0 : COMPANION_PORT;
+    }
+    if (panelPort > 0) {
+        panelListener = openListener(ENDPOINT_PANEL_LISTENER, panelPort);
+        if (panelListener == NULL) {
+            perror("listen");
+            return 1;
+        }
+        fprintf(stderr, "waiting for panels on port %d\n", panelPort);
+    }
+    if (ssePort > 0) {
+        sseListener = openListener(ENDPOINT_SSE_LISTENER, ssePort);
+        if (sseListener == NULL) {
+            perror("listen");
+            return 1;
+        }
+        fprintf(stderr, "serving SSE on port %d\n", ssePort);
+    }
+    if (multicastGroup && !openMulticast(multicastGroup)) {
+        return 1;
+    }
+
+    if (aidaHost == NULL) {
+        // 回放录制的数据, 代替AIDA64
+        replayFd = strcmp(argv[0], "-") == 0 ? STDIN_FILENO : open(argv[0], O_RDONLY);
+        if (replayFd < 0) {
+            perror(argv[0]);
+            return 1;
+        }
+        if (layoutPath) {
+            int layoutFd = open(layoutPath, O_RDONLY);
+            std::vector<char> page;
+            if (layoutFd >= 0) {
+                readAll(layoutFd, page);
+                close(layoutFd);
+            }
+            if (!parseLayoutPage(page, layout)) {
+                fprintf(stderr, "%s: no LCD items found\n", layoutPath);
+                return 1;
+            }
+            setPageBody(page);
+        } else {
+            // 页面中没有LCD项目时面板保留默认布局, 与这里的布局相同
+            static const char placeholder[] = "<html><body>aida64_companion replay</body></html>";
+            getDefaultAida64Layout(layout);
+            setPageBody(std::vector<char>(placeholder, placeholder + sizeof(placeholder) - 1));
+        }
+        setLayout(layout);
+        aida64StreamReset(stream);
+    } else {
+        char *colon = strrchr((char *)aidaHost, ':');
+        if (colon != NULL) {
+            *colon = '\0';
+            aidaPort = atoi(colon + 1);
+        }
+        connectUpstream();
+    }
+
+    struct epoll_event events[COMPANION_MAX_EVENTS];
+    while (1) {
+        uint64_t now = nowMs();
+        int timeout = -1;
+
+        if (replayFd >= 0) {
+            if (now >= nextReplayMs) {
+                if (!replayNext()) {
+                    close(replayFd);
+                    replayFd = -1;
+                    continue;
+                }
+                nextReplayMs = now + replayMs;
+            }
+            timeout = nextReplayMs > now ? nextReplayMs - now : 0;
+        } else if (aidaHost == NULL) {
+            // 回放结束, 发完排队的数据后退出
+            if (clientsDrained()) {
+                break;
+            }
+            timeout = 100;
+        } else if (upstream == NULL) {
+            if (now >= reconnectMs) {
+                connectUpstream();
+                continue;
+            }
+            timeout = reconnectMs - now;
+        }
+
+        int count = epoll_wait(epollFd, events, COMPANION_MAX_EVENTS, timeout);
+        if (count < 0 && errno != EINTR) {
+            perror("epoll_wait");
+            return 1;
+        }
+
+        for (int i = 0; i < count; i++) {
+            ENDPOINT *endpoint = (ENDPOINT *)events[i].data.ptr;
+            if (endpoint->fd < 0) {
+                continue;
+            }
+
+            switch (endpoint->kind) {
+                case ENDPOINT_PANEL_LISTENER:
+                case ENDPOINT_SSE_LISTENER:
+                    acceptClients(endpoint);
+                    break;
+                case ENDPOINT_UPSTREAM:
+                    readUpstream();
+                    break;
+                case ENDPOINT_PANEL:
+                    if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                        closeEndpoint(endpoint);
+                        break;
+                    }
+                    if (events[i].events & EPOLLIN) {
+                        // 面板不发送数据, 可读只意味着对端关闭
+                        char discard[64];
+                        ssize_t n = recv(endpoint->fd, discard, sizeof(discard), 0);
+                        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                            closeEndpoint(endpoint);
+                            break;
+                        }
+                    }
+                    if (events[i].events & EPOLLOUT) {
+                        flushEndpoint(endpoint);
+                    }
+                    break;
+                case ENDPOINT_SSE:
+                    if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                        closeEndpoint(endpoint);
+                        break;
+                    }
+                    if (events[i].events & EPOLLIN) {
+                        handleRequest(endpoint);
+                    }
+                    if (endpoint->fd >= 0 && (events[i].events & EPOLLOUT)) {
+                        flushEndpoint(endpoint);
+                    }
+                    break;
+            }
+        }
+
+        for (ENDPOINT *endpoint : closedEndpoints) {
+            delete endpoint;
+        }
+        closedEndpoints.clear();
+    }
+
+    fprintf(stderr, "%u frames, %llu SSE bytes -> %llu bytes sent, %u frames dropped, %u catch-up keyframes\n",
+            framesIn, (unsigned long long)bytesIn, (unsigned long long)bytesOut, framesDropped, catchups);
+    return 0;
+}
+
+#endif
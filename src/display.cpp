@@ -1,38 +1,79 @@
 #include "display.h"
 #include "config.h"
+#include "fixed_format.h"
+#include "metrics.h"
+#include "trace.h"
+#include "warm_cache.h"
+#include "alloc_track.h"
+#include "hal.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 
 // 静态缓冲区大小
 #define BUFFER_SIZE (MAX_X * MAX_Y / 4)
 
-SCREEN_DISPLAY_ENHANCED::SCREEN_DISPLAY_ENHANCED() : tft() {
+// 性能浮层默认是否显示
+#ifndef PERF_HUD_DEFAULT
+#define PERF_HUD_DEFAULT 0
+#endif
+#define PERF_HUD_PERIOD 1000
+// LVGL内存池的采样周期, 供 /metrics 和性能浮层使用
+#define POOL_SAMPLE_PERIOD 1000
+// 进度条的过渡时间, 与LVGL默认主题中进度条动画的时长相同
+#define BAR_ANIM_TIME 200
+
+// 时钟字段的文本, 通过lv_label_set_text_static引用, 不复制也不分配
+static const char clockDigits[60][3] = {
+    "00", "01", "02", "03", "04", "05", "06", "07", "08", "09",
+    "10", "11", "12", "13", "14", "15", "16", "17", "18", "19",
+    "20", "21", "22", "23", "24", "25", "26", "27", "28", "29",
+    "30", "31", "32", "33", "34", "35", "36", "37", "38", "39",
+    "40", "41", "42", "43", "44", "45", "46", "47", "48", "49",
+    "50", "51", "52", "53", "54", "55", "56", "57", "58", "59"
+};
+
+static const char* pageNumbers[PAGE_MAX] = {"1", "2", "3", "4", "5"};
+
+static const char* pageTitles[PAGE_MAX] = {
+    "AIDA64 System Monitor",
+    "CPU",
+    "GPU",
+    "Memory",
+    "Network",
+};
+
+SCREEN_DISPLAY_ENHANCED::SCREEN_DISPLAY_ENHANCED() {
     screen_dir = SCREEN_DIR_HORIZONTAL;
     disp = nullptr;
     buf1 = nullptr;
     buf2 = nullptr;
+    frame_flush_us = 0;
+    frame_flush_px = 0;
     
     // 初始化UI对象指针
     main_screen = nullptr;
     title_label = nullptr;
-    time_label = nullptr;
-    cpu_bar = nullptr;
-    cpu_label = nullptr;
-    gpu_bar = nullptr;
-    gpu_label = nullptr;
-    mem_bar = nullptr;
-    mem_label = nullptr;
-    
-    // 初始化额外信息标签指针
-    temp_label = nullptr;
-    gpu_temp_label = nullptr;
-    mem_usage_label = nullptr;
-    cpu_freq_label = nullptr;
-    cpu_power_label = nullptr;
-    gpu_power_label = nullptr;
-    gpu_mem_label = nullptr;
-    net_down_label = nullptr;
-    net_up_label = nullptr;
-    local_ip_label = nullptr;
-    external_ip_label = nullptr;
+    memset(clock_fields, 0, sizeof(clock_fields));
+    memset(clock_parts, 0, sizeof(clock_parts));
+    clock_seconds = -1;
+    indev = nullptr;
+    
+    // 初始化分页
+    current_page = PAGE_OVERVIEW;
+    pending_page = -1;
+    
+    // 初始化绑定表
+    layout_hash = 0;
+    binding_hint = 0;
+    
+    hud_label = nullptr;
+    hud_text[0] = '\0';
+    hud_visible = false;
+    hud_updated = 0;
+    pool_sampled = 0;
+    bars_animating = false;
 }
 
 SCREEN_DISPLAY_ENHANCED::~SCREEN_DISPLAY_ENHANCED() {
@@ -41,15 +82,34 @@ SCREEN_DISPLAY_ENHANCED::~SCREEN_DISPLAY_ENHANCED() {
 }
 
 void SCREEN_DISPLAY_ENHANCED::begin(int dir) {
-    // 初始化TFT
-    tft.init();
+    // 初始化屏幕、背光和触摸 (由HAL按平台实现)
+    halDisplayInit();
     setScreenDir(dir);
+    setBacklight(255);
     
     // 初始化LVGL
     initLVGL();
+    initTouch();
+    
+    // 有热启动快照时先按快照的布局和数值显示, 否则使用默认布局等待AIDA64布局发现
+    std::vector<AIDA64_LAYOUT_ITEM> layout;
+    std::vector<AIDA64_DATA> snapshot;
+    bool warm = warmCacheLoad(layout, snapshot);
+    if (warm) {
+        // 布局发现结果相同时哈希不变, 不会重建控件, 实时数据直接替换快照数值
+        publishAida64Layout(layout);
+        layout_hash = getAida64LayoutHash();
+    } else {
+        getDefaultAida64Layout(layout);
+    }
+    buildBindings(layout);
+    if (warm) {
+        applySnapshot(snapshot);
+    }
     
     // 创建UI
     createUI();
+    setPerfHud(PERF_HUD_DEFAULT);
     
     displayPrintLog("Enhanced display initialized with LVGL");
 }
@@ -58,12 +118,16 @@ void SCREEN_DISPLAY_ENHANCED::setScreenDir(int dir) {
     screen_dir = dir;
     
     if (screen_dir == SCREEN_DIR_VERTICAL) {
-        tft.setRotation(0);  // Portrait
+        halDisplayRotate(0);  // Portrait
     } else if (screen_dir == SCREEN_DIR_HORIZONTAL) {
-        tft.setRotation(1);  // Landscape
+        halDisplayRotate(1);  // Landscape
     }
 }
 
+void SCREEN_DISPLAY_ENHANCED::setBacklight(uint8_t level) {
+    halBacklight(level);
+}
+
 void SCREEN_DISPLAY_ENHANCED::initLVGL() {
     // 初始化LVGL
     lv_init();
@@ -84,518 +148,745 @@ void SCREEN_DISPLAY_ENHANCED::initLVGL() {
     lv_disp_drv_init(&disp_drv);
     disp_drv.hor_res = MAX_X;
     disp_drv.ver_res = MAX_Y;
-    disp_drv.flush_cb = disp_flush;
+#if LV_COLOR_16_SWAP
+    disp_drv.flush_cb = disp_flush<&halDisplayFlushPreswapped>;
+#else
+    disp_drv.flush_cb = disp_flush<&halDisplayFlushSwap>;
+#endif
     disp_drv.draw_buf = &draw_buf;
     disp_drv.user_data = this;
     
     // 注册显示驱动
     disp = lv_disp_drv_register(&disp_drv);
+    pacer.attach(disp);
+    
+    // 包装刷新定时器, 把一帧拆分为绘制和刷新两个阶段计时
+    lv_timer_t* refr_timer = _lv_disp_get_refr_timer(disp);
+    if (refr_timer) {
+        refr_timer->timer_cb = refr_timer_cb;
+    }
     
     displayPrintLog("LVGL initialized successfully");
 }
 
+void SCREEN_DISPLAY_ENHANCED::initTouch() {
+    lv_indev_drv_init(&indev_drv);
+    indev_drv.type = LV_INDEV_TYPE_POINTER;
+    indev_drv.read_cb = touch_read;
+    indev_drv.user_data = this;
+    indev = lv_indev_drv_register(&indev_drv);
+    
+    displayPrintLog("Touch initialized");
+}
+
 void SCREEN_DISPLAY_ENHANCED::createUI() {
-    // 创建主屏幕
-    main_screen = lv_scr_act();
+    showPage(current_page);
+    
+    displayPrintLog("UI created successfully");
+}
+
+void SCREEN_DISPLAY_ENHANCED::showPage(int page) {
+    lv_obj_t* old_screen = main_screen;
+    
+    // 旧页面的控件即将释放, 先解除绑定, 之后的更新只记录数值
+    memset(clock_fields, 0, sizeof(clock_fields));
+    for (auto& binding : bindings) {
+        binding.value_label = nullptr;
+        binding.bar = nullptr;
+    }
+    
+    // 每个页面是一个独立的屏幕对象, 在第一次显示时才创建
+    main_screen = lv_obj_create(NULL);
     lv_obj_set_style_bg_color(main_screen, lv_color_black(), 0);
+    lv_obj_clear_flag(main_screen, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_event_cb(main_screen, screen_event_cb, LV_EVENT_GESTURE, this);
+    lv_obj_add_event_cb(main_screen, screen_event_cb, LV_EVENT_SHORT_CLICKED, this);
+    lv_obj_add_event_cb(main_screen, screen_event_cb, LV_EVENT_LONG_PRESSED, this);
     
     // 创建标题
     title_label = lv_label_create(main_screen);
-    lv_label_set_text(title_label, "AIDA64 System Monitor");
+    lv_label_set_text_static(title_label, pageTitles[page]);
     lv_obj_set_style_text_color(title_label, lv_color_white(), 0);
     lv_obj_align(title_label, LV_ALIGN_TOP_MID, 0, 2);
     
-    // 统一布局：不使用标签页，所有信息显示在一个屏幕上
-    setupSingleScreenLayout();
+    // 页码
+    lv_obj_t* page_label = lv_label_create(main_screen);
+    lv_label_set_text_static(page_label, pageNumbers[page]);
+    lv_obj_set_style_text_color(page_label, lv_color_hex(0x666666), 0);
+    lv_obj_align(page_label, LV_ALIGN_TOP_RIGHT, -4, 2);
     
-    displayPrintLog("UI created successfully");
+    setupPageLayout(page);
+    
+    lv_scr_load(main_screen);
+    if (old_screen) {
+        lv_obj_del(old_screen);
+    }
+    current_page = page;
+    
+    displayPrintLog("Page %d shown\r\n", page);
 }
 
-void SCREEN_DISPLAY_ENHANCED::setupSingleScreenLayout() {
+bool SCREEN_DISPLAY_ENHANCED::pageContains(int page, const AIDA64_BINDING &binding) {
+    switch (page) {
+        case PAGE_OVERVIEW: return true;
+        case PAGE_CPU:      return binding.category == AIDA64_CPU;
+        case PAGE_GPU:      return binding.category == AIDA64_GPU;
+        case PAGE_MEMORY:   return binding.category == AIDA64_MEMORY;
+        case PAGE_NETWORK:  return binding.category == AIDA64_NETWORK;
+        default:            return false;
+    }
+}
+
+int SCREEN_DISPLAY_ENHANCED::nextPage(int step) {
+    int page = current_page;
+    
+    // 跳过当前布局中没有任何项目的详情页
+    for (int n = 0; n < PAGE_MAX; n++) {
+        page = (page + step + PAGE_MAX) % PAGE_MAX;
+        if (page == PAGE_OVERVIEW) {
+            return page;
+        }
+        for (const auto& binding : bindings) {
+            if (pageContains(page, binding)) {
+                return page;
+            }
+        }
+    }
+    return PAGE_OVERVIEW;
+}
+
+// 常见单词缩写, 保证标题在半屏宽度内放得下
+static const struct {
+    const char* word;
+    const char* abbr;
+} captionAbbrs[] = {
+    {"Memory", "Mem"},
+    {"External", "Ext"},
+    {"Download", "Down"},
+    {"Upload", "Up"},
+    {"Temperature", "Temp"},
+};
+
+static bool containsNoCase(const char* text, const char* word) {
+    size_t len = strlen(word);
+    for (const char* p = text; *p; p++) {
+        if (strncasecmp(p, word, len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 从AIDA64标签生成屏幕标题: 只保留ASCII (字库不含中文), 并缩写常见单词
+static void makeCaption(const char* label, bool first_word, char* caption, size_t size) {
+    char word[32];
+    size_t out = 0;
+    const char* p = label;
+    
+    caption[0] = '\0';
+    while (*p) {
+        size_t len = 0;
+        while (*p && !((unsigned char)*p >= 0x21 && (unsigned char)*p < 0x7F)) p++;
+        while ((unsigned char)*p >= 0x21 && (unsigned char)*p < 0x7F && len < sizeof(word) - 1) {
+            word[len++] = *p++;
+        }
+        while ((unsigned char)*p >= 0x21 && (unsigned char)*p < 0x7F) p++;
+        word[len] = '\0';
+        if (len == 0) break;
+        
+        const char* text = word;
+        for (const auto& abbr : captionAbbrs) {
+            if (strcasecmp(word, abbr.word) == 0) {
+                text = abbr.abbr;
+                break;
+            }
+        }
+        
+        size_t text_len = strlen(text);
+        if (out + text_len + (out ? 1 : 0) >= size) break;
+        if (out) caption[out++] = ' ';
+        memcpy(caption + out, text, text_len);
+        out += text_len;
+        caption[out] = '\0';
+        
+        if (first_word) break;
+    }
+}
+
+static AIDA64_CATEGORY guessCategory(const AIDA64_LAYOUT_ITEM& item) {
+    if (!item.numeric && strchr(item.label, ':') == NULL && containsNoCase(item.label, "IP")) {
+        return AIDA64_NETWORK;
+    }
+    if (containsNoCase(item.label, "GPU") || strstr(item.label, "显") != NULL) {
+        return AIDA64_GPU;
+    }
+    if (containsNoCase(item.label, "CPU")) {
+        return AIDA64_CPU;
+    }
+    if (containsNoCase(item.label, "Mem") || containsNoCase(item.label, "RAM") || strstr(item.label, "内存") != NULL) {
+        return AIDA64_MEMORY;
+    }
+    if (strstr(item.unit, "/s") != NULL || containsNoCase(item.label, "NIC")) {
+        return AIDA64_NETWORK;
+    }
+    if (containsNoCase(item.label, "Time") || strstr(item.label, "时间") != NULL) {
+        return AIDA64_TIME;
+    }
+    return AIDA64_OTHER;
+}
+
+// 按显示类型、类别和单位推断更新等级
+static AIDA64_RATE_CLASS guessRateClass(const AIDA64_BINDING& binding) {
+    // 利用率、网络吞吐量和时间每帧都可能变化
+    if (binding.kind == AIDA64_WIDGET_BAR || strstr(binding.unit, "/s") != NULL || binding.category == AIDA64_TIME) {
+        return RATE_FAST;
+    }
+    // IP等文本、显存容量
+    if (binding.kind == AIDA64_WIDGET_TEXT ||
+        (binding.category == AIDA64_GPU && (strcmp(binding.unit, "MB") == 0 || strcmp(binding.unit, "GB") == 0))) {
+        return RATE_VERY_SLOW;
+    }
+    // 频率、功耗、温度、电压、内存用量等
+    return RATE_SLOW;
+}
+
+// 按id指定更新等级, 在config.h中定义, 例如:
+// #define UPDATE_RATE_OVERRIDES {"Simple13", RATE_VERY_SLOW}, {"Simple5", RATE_FAST},
+static const struct {
+    const char* id;
+    AIDA64_RATE_CLASS rate;
+} rateOverrides[] = {
+#ifdef UPDATE_RATE_OVERRIDES
+    UPDATE_RATE_OVERRIDES
+#endif
+    {NULL, RATE_FAST},
+};
+
+static const uint32_t rateIntervals[RATE_CLASS_MAX] = {
+    UPDATE_RATE_FAST_INTERVAL,
+    UPDATE_RATE_SLOW_INTERVAL,
+    UPDATE_RATE_VERY_SLOW_INTERVAL,
+};
+
+static lv_color_t captionColor(AIDA64_CATEGORY category) {
+    switch (category) {
+        case AIDA64_CPU:    return lv_color_hex(0xFF6666);
+        case AIDA64_GPU:    return lv_color_hex(0x66FF66);
+        case AIDA64_MEMORY: return lv_color_hex(0x6666FF);
+        default:            return lv_color_hex(0xCCCCCC);
+    }
+}
+
+static lv_color_t barColor(AIDA64_CATEGORY category) {
+    switch (category) {
+        case AIDA64_CPU:    return lv_color_hex(0xFF4444);
+        case AIDA64_GPU:    return lv_color_hex(0x44FF44);
+        case AIDA64_MEMORY: return lv_color_hex(0x4444FF);
+        default:            return lv_color_hex(0xCCCCCC);
+    }
+}
+
+static lv_color_t valueColor(const AIDA64_BINDING& binding) {
+    if (binding.kind == AIDA64_WIDGET_TEXT) {
+        return lv_color_hex(0xCCFF66);
+    }
+    if (strstr(binding.unit, "/s") != NULL) {
+        return lv_color_hex(0x88FF88);
+    }
+    if (strcmp(binding.unit, "W") == 0) {
+        return lv_color_hex(0xFFCC66);
+    }
+    if (strchr(binding.unit, 'C') != NULL) {
+        return lv_color_hex(0x66CCFF);
+    }
+    if (binding.category == AIDA64_GPU) {
+        return lv_color_hex(0x66FFCC);
+    }
+    return lv_color_hex(0xCCCCCC);
+}
+
+void SCREEN_DISPLAY_ENHANCED::buildBindings(const std::vector<AIDA64_LAYOUT_ITEM> &layout) {
+    AIDA64_BINDING binding;
+    int rate_counts[RATE_CLASS_MAX] = {0};
+    
+    bindings.clear();
+    bindings.reserve(layout.size());
+    binding_hint = 0;
+    
+    for (const auto& item : layout) {
+        memset(&binding, 0, sizeof(binding));
+        strncpy(binding.id, item.id, sizeof(binding.id) - 1);
+        strncpy(binding.prefix, item.prefix, sizeof(binding.prefix) - 1);
+        strncpy(binding.unit, item.unit, sizeof(binding.unit) - 1);
+        binding.category = guessCategory(item);
+        
+        if (!item.numeric) {
+            binding.kind = AIDA64_WIDGET_TEXT;
+        } else if (strcmp(item.unit, "%") == 0) {
+            binding.kind = AIDA64_WIDGET_BAR;
+        } else {
+            binding.kind = AIDA64_WIDGET_VALUE;
+        }
+        
+        makeCaption(item.label, binding.kind != AIDA64_WIDGET_VALUE, binding.caption, sizeof(binding.caption));
+        if (binding.caption[0] == '\0') {
+            // 标签全部为中文等字库外字符时退回到id
+            strncpy(binding.caption, item.id, sizeof(binding.caption) - 1);
+        }
+        
+        binding.rate = guessRateClass(binding);
+        for (int i = 0; rateOverrides[i].id != NULL; i++) {
+            if (strcmp(rateOverrides[i].id, binding.id) == 0) {
+                binding.rate = rateOverrides[i].rate;
+                break;
+            }
+        }
+        rate_counts[binding.rate]++;
+        
+        bindings.push_back(binding);
+    }
+    
+    displayPrintLog("Built %u bindings (fast %d, slow %d, very slow %d)\r\n", (unsigned)bindings.size(),
+                    rate_counts[RATE_FAST], rate_counts[RATE_SLOW], rate_counts[RATE_VERY_SLOW]);
+}
+
+void SCREEN_DISPLAY_ENHANCED::syncLayout() {
+    uint32_t hash = getAida64LayoutHash();
+    
+    // 哈希未变化时不做任何事, 稳态下只有这一次比较
+    if (hash == 0 || hash == layout_hash) {
+        return;
+    }
+    
+    // 重建控件是预期内的分配, 重新预热后再检查稳态
+    allocRestartWarmup();
+    std::vector<AIDA64_LAYOUT_ITEM> layout;
+    layout_hash = copyAida64Layout(layout);
+    buildBindings(layout);
+    
+    // 当前详情页在新布局中可能已经没有项目
+    if (current_page != PAGE_OVERVIEW && nextPage(0) != current_page) {
+        current_page = PAGE_OVERVIEW;
+    }
+    createUI();
+    
+    displayPrintLog("Layout rebuilt (hash %08x)\r\n", layout_hash);
+}
+
+void SCREEN_DISPLAY_ENHANCED::setupPageLayout(int page) {
     int y_pos = 25; // 从标题下方开始
-    int col1_x = 10;   // 左列X位置
-    int col2_x = 170;  // 右列X位置（增加间距）
+    int col_x[2] = {10, 170};  // 左右两列X位置
+    int col_width = 155;
     int line_height = 28; // 增加行高，更大间距
     
     // === 第一行：时间（单独一行，居中） ===
-    time_label = lv_label_create(main_screen);
-    lv_label_set_text(time_label, "System Time: --:--:--");
-    lv_obj_set_style_text_color(time_label, lv_color_hex(0x00FF00), 0);
-    lv_obj_align(time_label, LV_ALIGN_TOP_MID, 0, y_pos);
-    y_pos += line_height;
-    
-    // === 第二行：CPU使用率 + CPU温度 ===
-    // CPU使用率（左列）
-    lv_obj_t* cpu_title = lv_label_create(main_screen);
-    lv_label_set_text(cpu_title, "CPU:");
-    lv_obj_set_style_text_color(cpu_title, lv_color_hex(0xFF6666), 0);
-    lv_obj_set_pos(cpu_title, col1_x, y_pos);
-    
-    cpu_label = lv_label_create(main_screen);
-    lv_label_set_text(cpu_label, "0%");
-    lv_obj_set_style_text_color(cpu_label, lv_color_white(), 0);
-    lv_obj_set_pos(cpu_label, col1_x + 40, y_pos);
-    
-    cpu_bar = lv_bar_create(main_screen);
-    lv_obj_set_size(cpu_bar, 70, 12);
-    lv_obj_set_pos(cpu_bar, col1_x + 85, y_pos + 2);
-    lv_obj_set_style_bg_color(cpu_bar, lv_color_hex(0x333333), LV_PART_MAIN);
-    lv_obj_set_style_bg_color(cpu_bar, lv_color_hex(0xFF4444), LV_PART_INDICATOR);
-    lv_bar_set_range(cpu_bar, 0, 100);
-    
-    // CPU温度（右列）
-    temp_label = lv_label_create(main_screen);
-    lv_label_set_text(temp_label, "CPU: --°C");
-    lv_obj_set_style_text_color(temp_label, lv_color_hex(0x66CCFF), 0);
-    lv_obj_set_pos(temp_label, col2_x, y_pos);
+    // 标题 + "HH" ":" "MM" ":" "SS", 数字段固定宽度, 数值变化只重绘该字段
+    static const char* clockTexts[6] = {"System Time: ", "--", ":", "--", ":", "--"};
+    for (int i = 0; i < 6; i++) {
+        clock_parts[i] = lv_label_create(main_screen);
+        lv_label_set_text_static(clock_parts[i], clockTexts[i]);
+        if (i % 2 == 1) {
+            lv_obj_set_width(clock_parts[i], 20);
+            lv_obj_set_style_text_align(clock_parts[i], LV_TEXT_ALIGN_CENTER, 0);
+            clock_fields[i / 2] = clock_parts[i];
+        }
+        if (i == 0) {
+            lv_obj_align(clock_parts[i], LV_ALIGN_TOP_MID, -36, y_pos);
+        } else {
+            lv_obj_align_to(clock_parts[i], clock_parts[i - 1], LV_ALIGN_OUT_RIGHT_MID, 0, 0);
+        }
+    }
+    memset(clock_values, -1, sizeof(clock_values));
+    clock_synced = -1;
     y_pos += line_height;
+    updateClock(clock_seconds);
     
-    // === 第三行：GPU使用率 + GPU温度 ===
-    // GPU使用率（左列）
-    lv_obj_t* gpu_title = lv_label_create(main_screen);
-    lv_label_set_text(gpu_title, "GPU:");
-    lv_obj_set_style_text_color(gpu_title, lv_color_hex(0x66FF66), 0);
-    lv_obj_set_pos(gpu_title, col1_x, y_pos);
-    
-    gpu_label = lv_label_create(main_screen);
-    lv_label_set_text(gpu_label, "0%");
-    lv_obj_set_style_text_color(gpu_label, lv_color_white(), 0);
-    lv_obj_set_pos(gpu_label, col1_x + 40, y_pos);
-    
-    gpu_bar = lv_bar_create(main_screen);
-    lv_obj_set_size(gpu_bar, 70, 12);
-    lv_obj_set_pos(gpu_bar, col1_x + 85, y_pos + 2);
-    lv_obj_set_style_bg_color(gpu_bar, lv_color_hex(0x333333), LV_PART_MAIN);
-    lv_obj_set_style_bg_color(gpu_bar, lv_color_hex(0x44FF44), LV_PART_INDICATOR);
-    lv_bar_set_range(gpu_bar, 0, 100);
-    
-    // GPU温度（右列）
-    gpu_temp_label = lv_label_create(main_screen);
-    lv_label_set_text(gpu_temp_label, "GPU: --°C");
-    lv_obj_set_style_text_color(gpu_temp_label, lv_color_hex(0x66CCFF), 0);
-    lv_obj_set_pos(gpu_temp_label, col2_x, y_pos);
-    y_pos += line_height;
+    // === 其余各行：按绑定表顺序两列排列 ===
+    std::vector<AIDA64_BINDING*> items;
+    for (auto& binding : bindings) {
+        if (pageContains(page, binding)) {
+            items.push_back(&binding);
+        }
+    }
     
-    // === 第四行：内存使用率 + CPU频率 ===
-    // 内存使用率（左列）
-    lv_obj_t* mem_title = lv_label_create(main_screen);
-    lv_label_set_text(mem_title, "MEM:");
-    lv_obj_set_style_text_color(mem_title, lv_color_hex(0x6666FF), 0);
-    lv_obj_set_pos(mem_title, col1_x, y_pos);
-    
-    mem_label = lv_label_create(main_screen);
-    lv_label_set_text(mem_label, "0%");
-    lv_obj_set_style_text_color(mem_label, lv_color_white(), 0);
-    lv_obj_set_pos(mem_label, col1_x + 40, y_pos);
-    
-    mem_bar = lv_bar_create(main_screen);
-    lv_obj_set_size(mem_bar, 70, 12);
-    lv_obj_set_pos(mem_bar, col1_x + 85, y_pos + 2);
-    lv_obj_set_style_bg_color(mem_bar, lv_color_hex(0x333333), LV_PART_MAIN);
-    lv_obj_set_style_bg_color(mem_bar, lv_color_hex(0x4444FF), LV_PART_INDICATOR);
-    lv_bar_set_range(mem_bar, 0, 100);
-    
-    // CPU频率（右列）
-    cpu_freq_label = lv_label_create(main_screen);
-    lv_label_set_text(cpu_freq_label, "CPU: -- MHz");
-    lv_obj_set_style_text_color(cpu_freq_label, lv_color_hex(0xCCCCCC), 0);
-    lv_obj_set_pos(cpu_freq_label, col2_x, y_pos);
-    y_pos += line_height;
+    int rows = (items.size() + 1) / 2;
+    if (rows > 1) {
+        int fit = (MAX_Y - y_pos - 16) / (rows - 1);
+        if (fit < line_height) line_height = (fit < 16) ? 16 : fit;
+    }
     
-    // === 第五行：内存使用量 + CPU功耗 ===
-    // 内存使用量（左列）
-    mem_usage_label = lv_label_create(main_screen);
-    lv_label_set_text(mem_usage_label, "Used: -- MB");
-    lv_obj_set_style_text_color(mem_usage_label, lv_color_hex(0xCCCCCC), 0);
-    lv_obj_set_pos(mem_usage_label, col1_x, y_pos);
-    
-    // CPU功耗（右列）
-    cpu_power_label = lv_label_create(main_screen);
-    lv_label_set_text(cpu_power_label, "CPU: -- W");
-    lv_obj_set_style_text_color(cpu_power_label, lv_color_hex(0xFFCC66), 0);
-    lv_obj_set_pos(cpu_power_label, col2_x, y_pos);
-    y_pos += line_height;
+    for (size_t i = 0; i < items.size(); i++) {
+        AIDA64_BINDING& binding = *items[i];
+        int x = col_x[i % 2];
+        int y = y_pos + (i / 2) * line_height;
+        char buffer[48];
+        
+        if (y > MAX_Y - 16) {
+            displayPrintLog("No room for %s, skipped\r\n", binding.id);
+            continue;
+        }
+        
+        if (binding.kind == AIDA64_WIDGET_BAR) {
+            lv_obj_t* title = lv_label_create(main_screen);
+            snprintf(buffer, sizeof(buffer), "%s:", binding.caption);
+            lv_label_set_text(title, buffer);
+            lv_obj_set_style_text_color(title, captionColor(binding.category), 0);
+            lv_obj_set_pos(title, x, y);
+            
+            binding.value_label = lv_label_create(main_screen);
+            lv_obj_set_style_text_color(binding.value_label, lv_color_white(), 0);
+            lv_obj_set_pos(binding.value_label, x + 40, y);
+            
+            binding.bar = lv_bar_create(main_screen);
+            lv_obj_set_size(binding.bar, 70, 12);
+            lv_obj_set_pos(binding.bar, x + 85, y + 2);
+            lv_obj_set_style_bg_color(binding.bar, lv_color_hex(0x333333), LV_PART_MAIN);
+            lv_obj_set_style_bg_color(binding.bar, barColor(binding.category), LV_PART_INDICATOR);
+            lv_bar_set_range(binding.bar, 0, 100);
+            binding.bar_shown = 0;
+        } else {
+            // 标题与数值分成两个标签: 标题只在页面创建时绘制一次,
+            // 数值更新的脏区域只覆盖数值标签, 不再重绘标题文字
+            lv_obj_t* title = lv_label_create(main_screen);
+            snprintf(buffer, sizeof(buffer), "%s:", binding.caption);
+            lv_label_set_text(title, buffer);
+            lv_obj_set_style_text_color(title, valueColor(binding), 0);
+            lv_obj_set_pos(title, x, y);
+            lv_obj_update_layout(title);
+            lv_coord_t title_width = lv_obj_get_width(title) + 4;
+            
+            // 固定宽度, 数值长度变化时脏区域不随文字伸缩
+            binding.value_label = lv_label_create(main_screen);
+            lv_label_set_long_mode(binding.value_label, LV_LABEL_LONG_CLIP);
+            lv_obj_set_width(binding.value_label, title_width < col_width ? col_width - title_width : 1);
+            lv_obj_set_style_text_color(binding.value_label, valueColor(binding), 0);
+            lv_obj_set_pos(binding.value_label, x + title_width, y);
+            binding.bar = nullptr;
+        }
+        
+        // 切换页面后下一帧立即更新, 不等慢速项目的间隔
+        binding.next_update_ms = halMillis();
+        
+        // 数值标签直接引用binding.text, 尚无数据时先填入占位文本
+        if (!binding.has_value) {
+            if (binding.kind == AIDA64_WIDGET_BAR) {
+                snprintf(binding.text, sizeof(binding.text), "0%%");
+            } else if (binding.kind == AIDA64_WIDGET_TEXT) {
+                snprintf(binding.text, sizeof(binding.text), "---.---.---.---");
+            } else {
+                snprintf(binding.text, sizeof(binding.text), "-- %s", binding.unit);
+            }
+            lv_label_set_text_static(binding.value_label, binding.text);
+        } else {
+            renderBinding(binding);
+        }
+        if (binding.stale) {
+            paintBinding(binding);
+        }
+    }
+}
+
+void SCREEN_DISPLAY_ENHANCED::displayAida64Data(std::vector<AIDA64_DATA> &dataList, uint32_t arrival_us) {
+    uint32_t start_us = halMicros();
+    bool updated;
+    TRACE_BEGIN_EVENT(TRACE_DISPATCH);
+    {
+        ALLOC_STAGE(STAGE_DISPATCH);
+        updated = updateSystemInfo(dataList);
+    }
+    TRACE_END_EVENT(TRACE_DISPATCH);
     
-    // === 第六行：已用显存 + GPU功耗 ===
-    // 已用显存（左列）
-    gpu_mem_label = lv_label_create(main_screen);
-    lv_label_set_text(gpu_mem_label, "VRAM: -- MB");
-    lv_obj_set_style_text_color(gpu_mem_label, lv_color_hex(0x66FFCC), 0);
-    lv_obj_set_pos(gpu_mem_label, col1_x, y_pos);
-    
-    // GPU功耗（右列）
-    gpu_power_label = lv_label_create(main_screen);
-    lv_label_set_text(gpu_power_label, "GPU: -- W");
-    lv_obj_set_style_text_color(gpu_power_label, lv_color_hex(0xFFCC66), 0);
-    lv_obj_set_pos(gpu_power_label, col2_x, y_pos);
-    y_pos += line_height;
+    metricsStage(STAGE_DISPATCH, halMicros() - start_us);
+    if (updated) {
+        pacer.requestFrame(arrival_us);
+    }
+    allocOnFrame();
+}
+
+void SCREEN_DISPLAY_ENHANCED::setPerfHud(bool visible) {
+    hud_visible = visible;
     
-    // === 第七行：网络下载 + 上传 ===
-    net_down_label = lv_label_create(main_screen);
-    lv_label_set_text(net_down_label, "Down: -- KB/s");
-    lv_obj_set_style_text_color(net_down_label, lv_color_hex(0x88FF88), 0);
-    lv_obj_set_pos(net_down_label, col1_x, y_pos);
+    if (!visible) {
+        if (hud_label) {
+            lv_obj_del(hud_label);
+            hud_label = nullptr;
+        }
+        return;
+    }
     
-    net_up_label = lv_label_create(main_screen);
-    lv_label_set_text(net_up_label, "Up: -- KB/s");
-    lv_obj_set_style_text_color(net_up_label, lv_color_hex(0xFF8888), 0);
-    lv_obj_set_pos(net_up_label, col2_x, y_pos);
-    y_pos += line_height;
+    if (hud_label == nullptr) {
+        // 固定尺寸的不透明浮层, 每次更新只重绘这一块区域
+        hud_label = lv_label_create(lv_layer_top());
+        lv_obj_set_size(hud_label, 180, 148);
+        lv_obj_align(hud_label, LV_ALIGN_BOTTOM_RIGHT, -2, -2);
+        lv_obj_set_style_bg_color(hud_label, lv_color_hex(0x202020), 0);
+        lv_obj_set_style_bg_opa(hud_label, LV_OPA_COVER, 0);
+        lv_obj_set_style_text_color(hud_label, lv_color_hex(0xFFFF66), 0);
+        lv_obj_set_style_pad_all(hud_label, 2, 0);
+        lv_label_set_long_mode(hud_label, LV_LABEL_LONG_CLIP);
+        lv_label_set_text_static(hud_label, "stage  min/avg/max");
+    }
     
-    // === 第八行：内部IP + 外部IP ===
-    local_ip_label = lv_label_create(main_screen);
-    lv_label_set_text(local_ip_label, "Local: ---.---.---.---");
-    lv_obj_set_style_text_color(local_ip_label, lv_color_hex(0xCCFF66), 0);
-    lv_obj_set_pos(local_ip_label, col1_x, y_pos);
+    // 丢弃浮层隐藏期间累积的统计
+    for (int stage = 0; stage < STAGE_MAX; stage++) {
+        STAGE_WINDOW window;
+        metricsTakeStageWindow((PIPELINE_STAGE)stage, window);
+    }
+    hud_updated = halMillis();
+}
+
+// 微秒值按量级输出为 "850us" 或 "12.3ms"
+static size_t formatStageTime(char* buf, size_t size, uint32_t us) {
+    size_t len;
     
-    external_ip_label = lv_label_create(main_screen);
-    lv_label_set_text(external_ip_label, "Ext: ---.---.---.---");
-    lv_obj_set_style_text_color(external_ip_label, lv_color_hex(0xFF66CC), 0);
-    lv_obj_set_pos(external_ip_label, col2_x, y_pos);
+    if (us < 1000) {
+        return snprintf(buf, size, "%uus", us);
+    }
+    len = formatFixed(buf, size, (int32_t)us, 3, 1);
+    return len + snprintf(buf + len, size - len, "ms");
 }
 
-void SCREEN_DISPLAY_ENHANCED::displayAida64Data(std::vector<AIDA64_DATA> &dataList) {
-    updateSystemInfo(dataList);
+void SCREEN_DISPLAY_ENHANCED::samplePool() {
+    lv_mem_monitor_t mon;
+    POOL_SNAPSHOT pool;
+    
+    lv_mem_monitor(&mon);
+    pool.free_bytes = mon.free_size;
+    pool.largest_free_bytes = mon.free_biggest_size;
+    pool.frag_pct = mon.frag_pct;
+    metricsSetPool(pool);
 }
 
-void SCREEN_DISPLAY_ENHANCED::updateTimeDisplay(const String& timeString) {
-    if (time_label) {
-        char timeBuffer[64];
-        snprintf(timeBuffer, sizeof(timeBuffer), "System Time: %s", timeString.c_str());
-        lv_label_set_text(time_label, timeBuffer);
+void SCREEN_DISPLAY_ENHANCED::updatePerfHud() {
+    char* text = hud_text;
+    size_t len = 0;
+    
+    len += snprintf(text + len, sizeof(hud_text) - len, "stage  min/avg/max\n");
+    for (int stage = 0; stage < STAGE_MAX; stage++) {
+        STAGE_WINDOW window;
+        metricsTakeStageWindow((PIPELINE_STAGE)stage, window);
         
-        // 设置时间同步状态颜色
-        if (timeString == "--:--:--") {
-            // 未同步时显示红色
-            lv_obj_set_style_text_color(time_label, lv_color_hex(0xFF4444), 0);
-        } else {
-            // 已同步时显示绿色
-            lv_obj_set_style_text_color(time_label, lv_color_hex(0x00FF00), 0);
+        len += snprintf(text + len, sizeof(hud_text) - len, "%-6s ", metricsStageName((PIPELINE_STAGE)stage));
+        if (window.count == 0) {
+            len += snprintf(text + len, sizeof(hud_text) - len, "-\n");
+            continue;
         }
-        
-        displayPrintLog("Time updated: %s\r\n", timeString.c_str());
+        len += formatStageTime(text + len, sizeof(hud_text) - len, window.min_us);
+        len += snprintf(text + len, sizeof(hud_text) - len, "/");
+        len += formatStageTime(text + len, sizeof(hud_text) - len, window.avg_us);
+        len += snprintf(text + len, sizeof(hud_text) - len, "/");
+        len += formatStageTime(text + len, sizeof(hud_text) - len, window.max_us);
+        len += snprintf(text + len, sizeof(hud_text) - len, "\n");
     }
+    len += snprintf(text + len, sizeof(hud_text) - len, "heap   %uKB\n", halFreeHeap() / 1024);
+    
+    POOL_SNAPSHOT pool;
+    metricsGetPool(pool);
+    snprintf(text + len, sizeof(hud_text) - len, "pool   %uKB %u%% frag", pool.free_bytes / 1024, pool.frag_pct);
+    
+    lv_label_set_text_static(hud_label, text);
 }
 
-void SCREEN_DISPLAY_ENHANCED::updateSystemInfo(std::vector<AIDA64_DATA> &dataList) {
-    char buffer[64];
-    bool display_updated = false;
+void SCREEN_DISPLAY_ENHANCED::updateClock(int32_t seconds_of_day) {
+    // 记录最近一次的时间, 新页面创建时直接显示
+    clock_seconds = seconds_of_day;
     
-    displayPrintLog("Updating system info with %d items\r\n", dataList.size());
+    if (clock_fields[0] == nullptr) {
+        return;
+    }
     
-    for (const auto& data : dataList) {
-        displayPrintLog("Processing: ID=%s, Value=%s\r\n", data.id, data.val);
-        
-        // 解析数值数据
-        const char* value_str = data.val;
-        
-        // 根据AIDA64的配置处理特定的ID
-        if (strcmp(data.id, "Simple1") == 0) {
-            // CPU使用率
-            float percentage = 0.0f;
-            if (sscanf(value_str, ">CPU使用率%f%%", &percentage) == 1 || 
-                sscanf(value_str, ">CPU 使用率 %f%%", &percentage) == 1) {
-                if (cpu_bar && cpu_label) {
-                    lv_bar_set_value(cpu_bar, (int)percentage, LV_ANIM_ON);
-                    snprintf(buffer, sizeof(buffer), "%.1f%%", percentage);
-                    lv_label_set_text(cpu_label, buffer);
-                    displayPrintLog("Updated CPU: %.1f%%\r\n", percentage);
-                    display_updated = true;
-                }
-            }
-        }
-        else if (strcmp(data.id, "Simple7") == 0) {
-            // 内存使用率
-            float percentage = 0.0f;
-            if (sscanf(value_str, ">内存使用率%f%%", &percentage) == 1 ||
-                sscanf(value_str, ">内存 使用率 %f%%", &percentage) == 1) {
-                if (mem_bar && mem_label) {
-                    lv_bar_set_value(mem_bar, (int)percentage, LV_ANIM_ON);
-                    snprintf(buffer, sizeof(buffer), "%.1f%%", percentage);
-                    lv_label_set_text(mem_label, buffer);
-                    displayPrintLog("Updated Memory: %.1f%%\r\n", percentage);
-                    display_updated = true;
-                }
-            }
-        }
-        else if (strcmp(data.id, "Simple2") == 0) {
-            // CPU温度
-            float temp = 0.0f;
-            if (sscanf(value_str, ">中央处理器(CPU) %f", &temp) == 1) {
-                if (temp_label) {
-                    snprintf(buffer, sizeof(buffer), "CPU: %.0f°C", temp);
-                    lv_label_set_text(temp_label, buffer);
-                    displayPrintLog("Updated CPU Temp: %.0f°C\r\n", temp);
-                    display_updated = true;
-                }
-            }
+    int8_t synced = seconds_of_day >= 0 ? 1 : 0;
+    int8_t values[3] = {-1, -1, -1};
+    if (synced) {
+        values[0] = seconds_of_day / 3600;
+        values[1] = seconds_of_day / 60 % 60;
+        values[2] = seconds_of_day % 60;
+    }
+    
+    for (int i = 0; i < 3; i++) {
+        if (values[i] != clock_values[i]) {
+            clock_values[i] = values[i];
+            lv_label_set_text_static(clock_fields[i], values[i] < 0 ? "--" : clockDigits[values[i]]);
         }
-        else if (strcmp(data.id, "Simple5") == 0) {
-            // GPU温度
-            float temp = 0.0f;
-            if (sscanf(value_str, ">GPU 1 %f", &temp) == 1) {
-                if (gpu_temp_label) {
-                    snprintf(buffer, sizeof(buffer), "GPU: %.0f°C", temp);
-                    lv_label_set_text(gpu_temp_label, buffer);
-                    displayPrintLog("Updated GPU Temp: %.0f°C\r\n", temp);
-                    display_updated = true;
-                }
-            }
+    }
+    
+    // 同步状态颜色: 未同步红色, 已同步绿色, 只在状态变化时设置
+    if (synced != clock_synced) {
+        clock_synced = synced;
+        lv_color_t color = synced ? lv_color_hex(0x00FF00) : lv_color_hex(0xFF4444);
+        for (int i = 0; i < 6; i++) {
+            lv_obj_set_style_text_color(clock_parts[i], color, 0);
         }
-        else if (strcmp(data.id, "Simple8") == 0) {
-            // 已用内存
-            float memory_mb = 0.0f;
-            if (sscanf(value_str, ">已用内存 %f MB", &memory_mb) == 1) {
-                if (mem_usage_label) {
-                    // 当内存使用超过1GB时，显示GB单位
-                    if (memory_mb >= 1024.0f) {
-                        float memory_gb = memory_mb / 1024.0f;
-                        snprintf(buffer, sizeof(buffer), "Used: %.1f GB", memory_gb);
-                        displayPrintLog("Updated Memory Usage: %.1f GB\r\n", memory_gb);
-                    } else {
-                        snprintf(buffer, sizeof(buffer), "Used: %.0f MB", memory_mb);
-                        displayPrintLog("Updated Memory Usage: %.0f MB\r\n", memory_mb);
-                    }
-                    lv_label_set_text(mem_usage_label, buffer);
-                    display_updated = true;
-                }
-            }
+    }
+}
+
+int SCREEN_DISPLAY_ENHANCED::findBinding(const char* id) {
+    size_t count = bindings.size();
+    
+    // 数据帧中项目顺序固定, 通常从上次命中的下一项开始就能找到
+    for (size_t n = 0; n < count; n++) {
+        size_t i = (binding_hint + n) % count;
+        if (strcmp(bindings[i].id, id) == 0) {
+            binding_hint = i + 1;
+            return i;
         }
-        else if (strcmp(data.id, "Simple3") == 0) {
-            // CPU频率
-            float freq = 0.0f;
-            if (sscanf(value_str, ">CPU 核心频率 %f MHz", &freq) == 1 ||
-                sscanf(value_str, ">CPU核心频率%fMHz", &freq) == 1) {
-                if (cpu_freq_label) {
-                    // 当频率超过1000MHz时，显示GHz单位
-                    if (freq >= 1000.0f) {
-                        float freq_ghz = freq / 1000.0f;
-                        snprintf(buffer, sizeof(buffer), "CPU: %.2f GHz", freq_ghz);
-                        displayPrintLog("Updated CPU Freq: %.2f GHz\r\n", freq_ghz);
-                    } else {
-                        snprintf(buffer, sizeof(buffer), "CPU: %.0f MHz", freq);
-                        displayPrintLog("Updated CPU Freq: %.0f MHz\r\n", freq);
-                    }
-                    lv_label_set_text(cpu_freq_label, buffer);
-                    display_updated = true;
-                }
-            }
+    }
+    return -1;
+}
+
+bool SCREEN_DISPLAY_ENHANCED::applyBinding(AIDA64_BINDING &binding, const char* value_str) {
+    const char* value = findAida64Value(value_str, binding.prefix);
+    char text[sizeof(binding.text)];
+    
+    if (binding.kind == AIDA64_WIDGET_TEXT) {
+        snprintf(text, sizeof(text), "%s", *value ? value : "---.---.---.---");
+    } else {
+        // 定点解析和格式化, 不经过float和snprintf
+        int32_t number = 0;
+        if (parseFixed(value, FIXED_DECIMALS, &number) == NULL) {
+            return false;
         }
-        else if (strcmp(data.id, "Simple4") == 0) {
-            // CPU功耗
-            float power = 0.0f;
-            if (sscanf(value_str, ">CPU Package %f W", &power) == 1 ||
-                sscanf(value_str, ">CPUPackage%fW", &power) == 1) {
-                if (cpu_power_label) {
-                    snprintf(buffer, sizeof(buffer), "CPU: %.1f W", power);
-                    lv_label_set_text(cpu_power_label, buffer);
-                    displayPrintLog("Updated CPU Power: %.1f W\r\n", power);
-                    display_updated = true;
-                }
-            }
+        formatFixedUnit(text, sizeof(text), number, FIXED_DECIMALS, binding.unit);
+        binding.bar_value = fixedToInt(number, FIXED_DECIMALS);
+    }
+    
+    // 显示内容没有变化时不触碰控件, 不产生脏区域; 快照数值即使相同也要恢复正常颜色
+    bool was_stale = binding.stale;
+    if (binding.has_value && !was_stale && strcmp(text, binding.text) == 0) {
+        return false;
+    }
+    strcpy(binding.text, text);
+    binding.has_value = true;
+    binding.stale = false;
+    
+    // 不在当前页面的项目只记录数值, 不产生任何控件更新
+    if (binding.value_label == nullptr) {
+        return false;
+    }
+    
+    renderBinding(binding);
+    if (was_stale) {
+        paintBinding(binding);
+    }
+    displayDebugLog("Updated %s: %s\r\n", binding.id, binding.text);
+    return true;
+}
+
+void SCREEN_DISPLAY_ENHANCED::renderBinding(AIDA64_BINDING &binding) {
+    if (binding.kind == AIDA64_WIDGET_BAR) {
+        // LV_ANIM_ON每次更新都会在LVGL内存池中分配一个lv_anim_t, 改为由tick()原地推进显示值
+        if (pacer.animationsEnabled() && binding.bar_shown != binding.bar_value) {
+            binding.bar_from = binding.bar_shown;
+            binding.bar_start_ms = halMillis();
+            bars_animating = true;
+        } else {
+            binding.bar_shown = binding.bar_value;
+            lv_bar_set_value(binding.bar, binding.bar_value, LV_ANIM_OFF);
         }
-        else if (strcmp(data.id, "Simple6") == 0) {
-            // GPU功耗
-            float power = 0.0f;
-            if (sscanf(value_str, ">GPU 1 %f W", &power) == 1 ||
-                sscanf(value_str, ">GPU1%fW", &power) == 1) {
-                if (gpu_power_label) {
-                    snprintf(buffer, sizeof(buffer), "GPU: %.1f W", power);
-                    lv_label_set_text(gpu_power_label, buffer);
-                    displayPrintLog("Updated GPU Power: %.1f W\r\n", power);
-                    display_updated = true;
-                }
-            }
+    }
+    // 标签引用binding.text, 原地更新后重新设置以触发重排和重绘
+    lv_label_set_text_static(binding.value_label, binding.text);
+}
+
+// 推进进度条的过渡, 只在显示值变化时更新控件; 关闭动画后直接跳到目标值
+void SCREEN_DISPLAY_ENHANCED::stepBars() {
+    uint32_t now = halMillis();
+    bool animating = false;
+    
+    for (auto& binding : bindings) {
+        if (binding.bar == nullptr || binding.bar_shown == binding.bar_value) {
+            continue;
         }
-        else if (strcmp(data.id, "Simple11") == 0) {
-            // GPU使用率
-            float percentage = 0.0f;
-            if (sscanf(value_str, ">GPU1 使用率 %f%%", &percentage) == 1 ||
-                sscanf(value_str, ">GPU1使用率%f%%", &percentage) == 1) {
-                if (gpu_bar && gpu_label) {
-                    lv_bar_set_value(gpu_bar, (int)percentage, LV_ANIM_ON);
-                    snprintf(buffer, sizeof(buffer), "%.1f%%", percentage);
-                    lv_label_set_text(gpu_label, buffer);
-                    displayPrintLog("Updated GPU: %.1f%%\r\n", percentage);
-                    display_updated = true;
-                }
-            }
+        
+        uint32_t elapsed = now - binding.bar_start_ms;
+        int32_t shown = binding.bar_value;
+        if (pacer.animationsEnabled() && elapsed < BAR_ANIM_TIME) {
+            shown = binding.bar_from + (binding.bar_value - binding.bar_from) * (int32_t)elapsed / BAR_ANIM_TIME;
+            animating = true;
         }
-        else if (strcmp(data.id, "Simple9") == 0) {
-            // 下载速率
-            if (net_down_label) {
-                // 解析网络速率，格式: >NIC[1-7]下载速率数值单位
-                float rate_value = 0.0f;
-                char rate_unit[16] = "KB/s";
-                
-                // 使用正则表达式风格的解析，匹配数值和单位
-                const char* ptr = value_str;
-                while (*ptr && !isdigit(*ptr) && *ptr != '.') ptr++; // 跳过非数字字符
-                
-                if (*ptr) {
-                    // 提取数值
-                    if (sscanf(ptr, "%f", &rate_value) == 1) {
-                        // 查找单位
-                        while (*ptr && (isdigit(*ptr) || *ptr == '.')) ptr++;
-                        
-                        // 提取单位部分（跳过中文字符）
-                        const char* unit_start = ptr;
-                        int unit_idx = 0;
-                        while (*unit_start && unit_idx < 15) {
-                            if ((*unit_start >= 'A' && *unit_start <= 'Z') || 
-                                (*unit_start >= 'a' && *unit_start <= 'z') ||
-                                *unit_start == '/' || *unit_start == 's') {
-                                rate_unit[unit_idx++] = *unit_start;
-                            }
-                            unit_start++;
-                        }
-                        rate_unit[unit_idx] = '\0';
-                        
-                        if (strlen(rate_unit) == 0) {
-                            strcpy(rate_unit, "KB/s");
-                        }
-                        
-                        // 单位转换：当速度超过1MB/s时显示MB/s
-                        if (strcmp(rate_unit, "KB/s") == 0 && rate_value >= 1024.0f) {
-                            rate_value = rate_value / 1024.0f;
-                            strcpy(rate_unit, "MB/s");
-                            snprintf(buffer, sizeof(buffer), "Down: %.1f %s", rate_value, rate_unit);
-                        } else {
-                            snprintf(buffer, sizeof(buffer), "Down: %.1f %s", rate_value, rate_unit);
-                        }
-                    }
-                } else {
-                    snprintf(buffer, sizeof(buffer), "Down: 0.0 KB/s");
-                }
-                
-                lv_label_set_text(net_down_label, buffer);
-                displayPrintLog("Updated Download: %s (raw: %s)\r\n", buffer, value_str);
-                display_updated = true;
-            }
+        
+        if (shown != binding.bar_shown) {
+            binding.bar_shown = shown;
+            lv_bar_set_value(binding.bar, shown, LV_ANIM_OFF);
         }
-        else if (strcmp(data.id, "Simple10") == 0) {
-            // 上传速率
-            if (net_up_label) {
-                // 解析网络速率，格式: >NIC[1-7]上传速率数值单位
-                float rate_value = 0.0f;
-                char rate_unit[16] = "KB/s";
-                
-                // 使用正则表达式风格的解析，匹配数值和单位
-                const char* ptr = value_str;
-                while (*ptr && !isdigit(*ptr) && *ptr != '.') ptr++; // 跳过非数字字符
-                
-                if (*ptr) {
-                    // 提取数值
-                    if (sscanf(ptr, "%f", &rate_value) == 1) {
-                        // 查找单位
-                        while (*ptr && (isdigit(*ptr) || *ptr == '.')) ptr++;
-                        
-                        // 提取单位部分（跳过中文字符）
-                        const char* unit_start = ptr;
-                        int unit_idx = 0;
-                        while (*unit_start && unit_idx < 15) {
-                            if ((*unit_start >= 'A' && *unit_start <= 'Z') || 
-                                (*unit_start >= 'a' && *unit_start <= 'z') ||
-                                *unit_start == '/' || *unit_start == 's') {
-                                rate_unit[unit_idx++] = *unit_start;
-                            }
-                            unit_start++;
-                        }
-                        rate_unit[unit_idx] = '\0';
-                        
-                        if (strlen(rate_unit) == 0) {
-                            strcpy(rate_unit, "KB/s");
-                        }
-                        
-                        // 单位转换：当速度超过1MB/s时显示MB/s
-                        if (strcmp(rate_unit, "KB/s") == 0 && rate_value >= 1024.0f) {
-                            rate_value = rate_value / 1024.0f;
-                            strcpy(rate_unit, "MB/s");
-                            snprintf(buffer, sizeof(buffer), "Up: %.1f %s", rate_value, rate_unit);
-                        } else {
-                            snprintf(buffer, sizeof(buffer), "Up: %.1f %s", rate_value, rate_unit);
-                        }
-                    }
-                } else {
-                    snprintf(buffer, sizeof(buffer), "Up: 0.0 KB/s");
-                }
-                
-                lv_label_set_text(net_up_label, buffer);
-                displayPrintLog("Updated Upload: %s (raw: %s)\r\n", buffer, value_str);
-                display_updated = true;
-            }
+    }
+    
+    bars_animating = animating;
+}
+
+// 按数据状态设置颜色: 快照数值为灰色, 实时数值为正常颜色, 只在状态切换时调用
+void SCREEN_DISPLAY_ENHANCED::paintBinding(AIDA64_BINDING &binding) {
+    lv_color_t stale_color = lv_color_hex(0x666666);
+    
+    if (binding.kind == AIDA64_WIDGET_BAR) {
+        lv_obj_set_style_bg_color(binding.bar, binding.stale ? stale_color : barColor(binding.category), LV_PART_INDICATOR);
+        lv_obj_set_style_text_color(binding.value_label, binding.stale ? stale_color : lv_color_white(), 0);
+    } else {
+        lv_obj_set_style_text_color(binding.value_label, binding.stale ? stale_color : valueColor(binding), 0);
+    }
+}
+
+void SCREEN_DISPLAY_ENHANCED::applySnapshot(std::vector<AIDA64_DATA> &snapshot) {
+    // 控件尚未创建, 这里只记录数值, 页面创建时按灰色绘制
+    for (const auto& data : snapshot) {
+        int index = findBinding(data.id);
+        if (index >= 0) {
+            applyBinding(bindings[index], data.val);
+            bindings[index].stale = bindings[index].has_value;
         }
-        else if (strcmp(data.id, "Simple12") == 0) {
-            // 主IP地址
-            if (local_ip_label) {
-                // 提取IP地址部分
-                const char* ip_start = value_str;
-                while (*ip_start && !isdigit(*ip_start)) {
-                    ip_start++;
-                }
-                
-                if (ip_start && *ip_start) {
-                    snprintf(buffer, sizeof(buffer), "Local: %s", ip_start);
-                } else {
-                    snprintf(buffer, sizeof(buffer), "Local: ---.---.---.---");
-                }
-                lv_label_set_text(local_ip_label, buffer);
-                displayPrintLog("Updated Local IP: %s\r\n", value_str);
-                display_updated = true;
-            }
+    }
+    
+    displayPrintLog("Showing %u snapshot values until live data arrives\r\n", (unsigned)snapshot.size());
+}
+
+bool SCREEN_DISPLAY_ENHANCED::updateSystemInfo(std::vector<AIDA64_DATA> &dataList) {
+    bool display_updated = false;
+    
+    // 布局哈希变化时重建绑定表和控件
+    syncLayout();
+    
+    displayDebugLog("Updating system info with %u items\r\n", (unsigned)dataList.size());
+    
+    uint32_t now = halMillis();
+    uint32_t applied = 0;
+    uint32_t decimated = 0;
+    uint32_t widgets = 0;
+    
+    for (const auto& data : dataList) {
+        int index = findBinding(data.id);
+        if (index < 0) {
+            continue;
         }
-        else if (strcmp(data.id, "Simple13") == 0) {
-            // 外部IP地址
-            if (external_ip_label) {
-                // 提取IP地址部分
-                const char* ip_start = value_str;
-                while (*ip_start && !isdigit(*ip_start)) {
-                    ip_start++;
-                }
-                
-                if (ip_start && *ip_start) {
-                    snprintf(buffer, sizeof(buffer), "Ext: %s", ip_start);
-                } else {
-                    snprintf(buffer, sizeof(buffer), "Ext: ---.---.---.---");
-                }
-                lv_label_set_text(external_ip_label, buffer);
-                displayPrintLog("Updated External IP: %s\r\n", value_str);
-                display_updated = true;
-            }
+        
+        // 按更新等级抽取: 间隔未到时跳过解析和控件更新; 快照数值要尽快被实时数据替换
+        AIDA64_BINDING& binding = bindings[index];
+        if (binding.has_value && !binding.stale && (int32_t)(now - binding.next_update_ms) < 0) {
+            decimated++;
+            continue;
         }
-        else if (strcmp(data.id, "Simple14") == 0) {
-            // 已用显存
-            float vram_mb = 0.0f;
-            if (sscanf(value_str, ">已用显存 %f MB", &vram_mb) == 1 ||
-                sscanf(value_str, ">已用显存%fMB", &vram_mb) == 1) {
-                if (gpu_mem_label) {
-                    // 当显存使用超过1GB时，显示GB单位
-                    if (vram_mb >= 1024.0f) {
-                        float vram_gb = vram_mb / 1024.0f;
-                        snprintf(buffer, sizeof(buffer), "VRAM: %.1f GB", vram_gb);
-                        displayPrintLog("Updated GPU Memory: %.1f GB\r\n", vram_gb);
-                    } else {
-                        snprintf(buffer, sizeof(buffer), "VRAM: %.0f MB", vram_mb);
-                        displayPrintLog("Updated GPU Memory: %.0f MB\r\n", vram_mb);
-                    }
-                    lv_label_set_text(gpu_mem_label, buffer);
-                    display_updated = true;
-                }
-            }
+        binding.next_update_ms = now + rateIntervals[binding.rate];
+        applied++;
+        
+        if (applyBinding(binding, data.val)) {
+            display_updated = true;
+            widgets++;
         }
     }
     
-    // 如果有数据更新，强制刷新显示
+    metricsInc(METRIC_BINDINGS_APPLIED, applied);
+    metricsInc(METRIC_BINDINGS_DECIMATED, decimated);
+    metricsInc(METRIC_WIDGET_UPDATES, widgets);
+    
+    // 控件自身已标记脏区域, 由帧节拍器在下一个帧槽统一渲染
     if (display_updated) {
-        lv_obj_invalidate(main_screen);
-        lv_refr_now(disp);
-        displayPrintLog("Display refreshed after data update\r\n");
+        pacer.markDirty();
     }
+    
+    return display_updated;
 }
 
 void SCREEN_DISPLAY_ENHANCED::clear() {
     if (main_screen) {
-        lv_obj_clean(main_screen);
         createUI();
     }
 }
@@ -604,27 +895,128 @@ void SCREEN_DISPLAY_ENHANCED::updateDisplay() {
     // LVGL 自动处理显示更新
 }
 
-void SCREEN_DISPLAY_ENHANCED::tick() {
-    lv_timer_handler();
+uint32_t SCREEN_DISPLAY_ENHANCED::tick() {
+    if (bars_animating) {
+        stepBars();
+    }
+    
+    uint32_t wait = pacer.service();
+    
+    // 过渡期间每个帧周期推进一次
+    if (bars_animating && wait > pacer.framePeriod()) {
+        wait = pacer.framePeriod();
+    }
+    
+    // LVGL不是线程安全的, 内存池只在显示任务中采样
+    if (halMillis() - pool_sampled >= POOL_SAMPLE_PERIOD) {
+        pool_sampled = halMillis();
+        samplePool();
+    }
+    
+    if (hud_visible && halMillis() - hud_updated >= PERF_HUD_PERIOD) {
+        hud_updated = halMillis();
+        updatePerfHud();
+    }
+    
+    // 页面切换推迟到事件处理之外, 避免在屏幕自身的事件回调中删除它
+    if (pending_page >= 0) {
+        int page = pending_page;
+        pending_page = -1;
+        if (page != current_page) {
+            showPage(page);
+        }
+        wait = 1;
+    }
+    
+    return wait;
 }
 
 // 静态回调函数
+// 按像素格式在编译期特化的刷新路径, FLUSH为对应字节序的HAL入口 (见hal.h)
+template <HAL_FLUSH_FN FLUSH>
 void SCREEN_DISPLAY_ENHANCED::disp_flush(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_p) {
     SCREEN_DISPLAY_ENHANCED* display = (SCREEN_DISPLAY_ENHANCED*)disp_drv->user_data;
+    uint32_t start_us = halMicros();
+    TRACE_SCOPE(TRACE_FLUSH);
+    ALLOC_STAGE(STAGE_FLUSH);
     
     uint32_t w = (area->x2 - area->x1 + 1);
     uint32_t h = (area->y2 - area->y1 + 1);
     
-    display->tft.startWrite();
-    display->tft.setAddrWindow(area->x1, area->y1, w, h);
-    display->tft.pushColors((uint16_t*)&color_p->full, w * h, true);
-    display->tft.endWrite();
+    FLUSH(area->x1, area->y1, w, h, &color_p->full);
+    
+    metricsInc(METRIC_FLUSH_AREAS);
+    metricsInc(METRIC_FLUSH_PIXELS, w * h);
+    display->frame_flush_us += halMicros() - start_us;
+    display->frame_flush_px += w * h;
+    
+    if (lv_disp_flush_is_last(disp_drv)) {
+        display->pacer.onFlushComplete();
+    }
     
     lv_disp_flush_ready(disp_drv);
 }
 
-void SCREEN_DISPLAY_ENHANCED::disp_flush_ready(lv_disp_drv_t* disp_drv) {
-    // 刷新完成回调
+void SCREEN_DISPLAY_ENHANCED::refr_timer_cb(lv_timer_t* timer) {
+    lv_disp_t* disp = (lv_disp_t*)timer->user_data;
+    SCREEN_DISPLAY_ENHANCED* display = (SCREEN_DISPLAY_ENHANCED*)disp->driver->user_data;
+    uint32_t start_us = halMicros();
+    ALLOC_STAGE(STAGE_RENDER);
+    
+    display->frame_flush_us = 0;
+    display->frame_flush_px = 0;
+    TRACE_BEGIN_EVENT(TRACE_REFRESH);
+    _lv_disp_refr_timer(timer);
+    TRACE_END_EVENT(TRACE_REFRESH);
+    
+    // 没有脏区域时LVGL直接返回, 不计为一帧
+    if (display->frame_flush_px == 0) {
+        return;
+    }
+    
+    uint32_t total_us = halMicros() - start_us;
+    metricsStage(STAGE_RENDER, total_us - display->frame_flush_us);
+    metricsStage(STAGE_FLUSH, display->frame_flush_us);
+    display->pacer.onFrameRendered(total_us, display->frame_flush_px);
+}
+
+void SCREEN_DISPLAY_ENHANCED::touch_read(lv_indev_drv_t* indev_drv, lv_indev_data_t* data) {
+    int16_t x, y;
+    
+    if (halTouchRead(&x, &y)) {
+        data->point.x = x;
+        data->point.y = y;
+        data->state = LV_INDEV_STATE_PRESSED;
+    } else {
+        data->state = LV_INDEV_STATE_RELEASED;
+    }
+}
+
+void SCREEN_DISPLAY_ENHANCED::screen_event_cb(lv_event_t* e) {
+    SCREEN_DISPLAY_ENHANCED* display = (SCREEN_DISPLAY_ENHANCED*)lv_event_get_user_data(e);
+    lv_indev_t* indev = lv_indev_get_act();
+    int step = 0;
+    
+    if (lv_event_get_code(e) == LV_EVENT_GESTURE) {
+        // 左滑下一页, 右滑上一页
+        lv_dir_t dir = lv_indev_get_gesture_dir(indev);
+        if (dir == LV_DIR_LEFT) step = 1;
+        else if (dir == LV_DIR_RIGHT) step = -1;
+    } else if (lv_event_get_code(e) == LV_EVENT_LONG_PRESSED) {
+        // 长按切换性能浮层
+        display->setPerfHud(!display->hud_visible);
+        return;
+    } else {
+        // 点击屏幕右半边下一页, 左半边上一页
+        lv_point_t point;
+        lv_indev_get_point(indev, &point);
+        step = (point.x >= MAX_X / 2) ? 1 : -1;
+    }
+    
+    // 一次滑动会同时产生手势和点击事件, 只处理第一个
+    if (step != 0 && display->pending_page < 0) {
+        display->pending_page = display->nextPage(step);
+    }
 }
 
 // 全局实例
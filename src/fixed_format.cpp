@@ -0,0 +1,188 @@
+#include "fixed_format.h"
+#include <string.h>
+
+static const int32_t pow10Table[] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+// 各单位的换算规则, 与之前 snprintf 版本的输出格式保持一致
+static const struct
+{
+    const char *unit;
+    int32_t threshold;      // 不小于该值时换算到大单位
+    int32_t divisor;
+    const char *big_unit;
+    uint8_t small_decimals;
+    uint8_t big_decimals;
+    const char *separator;
+} unitScales[] = {
+    {"%",    0,    1,    NULL,   1, 1, ""},
+    {"MB",   1024, 1024, "GB",   0, 1, " "},
+    {"MHz",  1000, 1000, "GHz",  0, 2, " "},
+    {"KB/s", 1024, 1024, "MB/s", 1, 1, " "},
+};
+
+static int32_t clampInt32(int64_t value)
+{
+    if (value > INT32_MAX) return INT32_MAX;
+    if (value < INT32_MIN) return INT32_MIN;
+    return (int32_t)value;
+}
+
+// 四舍五入 (远离零) 的整数除法
+static int64_t divRound(int64_t value, int64_t divisor)
+{
+    if (value < 0) {
+        return -((-value + divisor / 2) / divisor);
+    }
+    return (value + divisor / 2) / divisor;
+}
+
+const char *parseFixed(const char *str, uint8_t decimals, int32_t *value)
+{
+    const char *p = str;
+    int64_t result = 0;
+    uint8_t frac = 0;
+    bool negative = false;
+    bool digits = false;
+
+    if (*p == '-' || *p == '+') {
+        negative = (*p == '-');
+        p++;
+    }
+
+    while (*p >= '0' && *p <= '9') {
+        if (result < INT32_MAX) {
+            result = result * 10 + (*p - '0');
+        }
+        digits = true;
+        p++;
+    }
+
+    if (*p == '.') {
+        p++;
+        while (*p >= '0' && *p <= '9') {
+            // 多余的小数位直接截断: 显示时的舍入边界都落在 decimals 位小数的网格上,
+            // 截断后再舍入与对原文本直接舍入结果相同, 先四舍五入则会二次舍入 (0.045 -> 0.05 -> 0.1)
+            if (frac < decimals) {
+                result = result * 10 + (*p - '0');
+                frac++;
+            }
+            digits = true;
+            p++;
+        }
+    }
+
+    if (!digits) {
+        return NULL;
+    }
+
+    for (; frac < decimals; frac++) {
+        result *= 10;
+    }
+
+    *value = clampInt32(negative ? -result : result);
+    return p;
+}
+
+static size_t writeUnsigned(char *buf, size_t size, uint32_t value, uint8_t minDigits)
+{
+    char digits[12];
+    size_t count = 0;
+    size_t len = 0;
+
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0 || count < minDigits);
+
+    while (count > 0 && len + 1 < size) {
+        buf[len++] = digits[--count];
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+size_t formatFixed(char *buf, size_t size, int32_t value, uint8_t decimals_in, uint8_t decimals_out)
+{
+    int64_t scaled = value;
+    uint64_t magnitude;
+    size_t len = 0;
+
+    if (size == 0) {
+        return 0;
+    }
+
+    if (decimals_out < decimals_in) {
+        scaled = divRound(scaled, pow10Table[decimals_in - decimals_out]);
+    } else {
+        scaled *= pow10Table[decimals_out - decimals_in];
+    }
+
+    // 与printf一致, 负数舍入到0时仍保留负号
+    if (value < 0 && len + 1 < size) {
+        buf[len++] = '-';
+    }
+    magnitude = scaled < 0 ? -scaled : scaled;
+
+    len += writeUnsigned(buf + len, size - len, (uint32_t)(magnitude / pow10Table[decimals_out]), 1);
+    if (decimals_out > 0 && len + 1 < size) {
+        buf[len++] = '.';
+        len += writeUnsigned(buf + len, size - len, (uint32_t)(magnitude % pow10Table[decimals_out]), decimals_out);
+    }
+
+    buf[len] = '\0';
+    return len;
+}
+
+static size_t appendText(char *buf, size_t size, size_t len, const char *text)
+{
+    while (*text && len + 1 < size) {
+        buf[len++] = *text++;
+    }
+    buf[len] = '\0';
+    return len;
+}
+
+size_t formatFixedUnit(char *buf, size_t size, int32_t value, uint8_t decimals, const char *unit)
+{
+    size_t len;
+
+    if (size == 0) {
+        return 0;
+    }
+
+    for (const auto &scale : unitScales) {
+        if (strcmp(unit, scale.unit) != 0) {
+            continue;
+        }
+
+        if (scale.big_unit != NULL && value >= (int64_t)scale.threshold * pow10Table[decimals]) {
+            int32_t big = clampInt32(divRound((int64_t)value * pow10Table[scale.big_decimals],
+                                              (int64_t)scale.divisor * pow10Table[decimals]));
+            len = formatFixed(buf, size, big, scale.big_decimals, scale.big_decimals);
+            len = appendText(buf, size, len, scale.separator);
+            return appendText(buf, size, len, scale.big_unit);
+        }
+
+        len = formatFixed(buf, size, value, decimals, scale.small_decimals);
+        len = appendText(buf, size, len, scale.separator);
+        return appendText(buf, size, len, unit);
+    }
+
+    // 温度 (°C / C) 取整且紧贴单位, 其余保留一位小数
+    if (strchr(unit, 'C') != NULL && strchr(unit, '/') == NULL) {
+        len = formatFixed(buf, size, value, decimals, 0);
+        return appendText(buf, size, len, unit);
+    }
+
+    len = formatFixed(buf, size, value, decimals, 1);
+    if (unit[0] != '\0') {
+        len = appendText(buf, size, len, " ");
+        len = appendText(buf, size, len, unit);
+    }
+    return len;
+}
+
+int32_t fixedToInt(int32_t value, uint8_t decimals)
+{
+    return value / pow10Table[decimals];
+}
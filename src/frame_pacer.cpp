@@ -0,0 +1,176 @@
+#include "frame_pacer.h"
+#include "hal.h"
+#include "metrics.h"
+
+// 调节器评估窗口
+#define PACER_WINDOW_MS 1000
+// 连续多少个窗口有压力才降级 / 有余量才升级
+#define PACER_DOWN_WINDOWS 2
+#define PACER_UP_WINDOWS 5
+
+// 各质量等级对应的刷新周期 (毫秒)
+static const uint32_t qualityPeriods[QUALITY_MAX] = {
+    LV_DISP_DEF_REFR_PERIOD,
+    LV_DISP_DEF_REFR_PERIOD,
+    LV_DISP_DEF_REFR_PERIOD * 2,
+    LV_DISP_DEF_REFR_PERIOD * 4,
+};
+
+static const char* qualityNames[QUALITY_MAX] = {
+    "full",
+    "no-anim",
+    "reduced-rate",
+    "minimum",
+};
+
+FramePacer::FramePacer() {
+    disp = nullptr;
+    quality = QUALITY_FULL;
+    window_start = 0;
+    frame_avg_us = 0;
+    frames = 0;
+    pixels = 0;
+    pending_updates = 0;
+    pressure_windows = 0;
+    headroom_windows = 0;
+    last_frame_ms = 0;
+    pending_arrival_us = 0;
+    latency_last_us = 0;
+    latency_max_us = 0;
+    latency_sum_us = 0;
+    latency_count = 0;
+}
+
+void FramePacer::attach(lv_disp_t* display) {
+    disp = display;
+    window_start = halMillis();
+    setQuality(QUALITY_FULL);
+}
+
+uint32_t FramePacer::framePeriod() const {
+    return qualityPeriods[quality];
+}
+
+uint32_t FramePacer::service() {
+    uint32_t wait = lv_timer_handler();
+
+    if (halMillis() - window_start >= PACER_WINDOW_MS) {
+        evaluate();
+    }
+
+    // 没有到期的定时器时休眠到下一个定时器, 而不是固定轮询
+    if (wait < 1) wait = 1;
+    if (wait > LV_INDEV_DEF_READ_PERIOD) wait = LV_INDEV_DEF_READ_PERIOD;
+    return wait;
+}
+
+void FramePacer::requestFrame(uint32_t arrival_us) {
+    // 同一帧槽内的多次数据只保留最早的到达时间
+    if (arrival_us != 0 && pending_arrival_us == 0) {
+        pending_arrival_us = arrival_us;
+    }
+
+    // 距离上一帧已超过一个帧周期时不再等待刷新定时器
+    if (disp && halMillis() - last_frame_ms >= framePeriod()) {
+        lv_timer_t* refr_timer = _lv_disp_get_refr_timer(disp);
+        if (refr_timer) {
+            lv_timer_ready(refr_timer);
+        }
+    }
+}
+
+void FramePacer::setPaused(bool paused) {
+    if (disp == nullptr) {
+        return;
+    }
+
+    lv_timer_t* refr_timer = _lv_disp_get_refr_timer(disp);
+    if (refr_timer == nullptr) {
+        return;
+    }
+
+    if (paused) {
+        lv_timer_pause(refr_timer);
+    } else {
+        lv_timer_resume(refr_timer);
+        lv_timer_ready(refr_timer);
+    }
+}
+
+void FramePacer::onFlushComplete() {
+    if (pending_arrival_us == 0) {
+        return;
+    }
+
+    latency_last_us = halMicros() - pending_arrival_us;
+    pending_arrival_us = 0;
+    metricsObserve(METRIC_LATENCY_US, latency_last_us);
+
+    if (latency_last_us > latency_max_us) latency_max_us = latency_last_us;
+    latency_sum_us += latency_last_us;
+    latency_count++;
+}
+
+void FramePacer::onFrameRendered(uint32_t render_us, uint32_t px) {
+    // EWMA, alpha = 1/8
+    if (frames == 0 && frame_avg_us == 0) {
+        frame_avg_us = render_us;
+    } else {
+        frame_avg_us = frame_avg_us - (frame_avg_us >> 3) + (render_us >> 3);
+    }
+
+    metricsObserve(METRIC_RENDER_US, render_us);
+
+    frames++;
+    pixels += px;
+    last_frame_ms = halMillis();
+}
+
+void FramePacer::evaluate() {
+    uint32_t budget_us = framePeriod() * 1000;
+    uint32_t load = 100 - lv_timer_get_idle();
+    bool pressure = (frame_avg_us > budget_us * 3 / 4) || load > 80;
+    bool headroom = (frame_avg_us < budget_us / 3) && load < 50;
+
+    if (frames > 0 || pending_updates > 0) {
+        pacerPrintLog("quality=%s frames=%u updates=%u pixels=%u avg=%uus load=%u%%\r\n",
+                      qualityNames[quality], frames, pending_updates, pixels, frame_avg_us, load);
+    }
+
+    if (latency_count > 0) {
+        pacerPrintLog("data->flush latency: last=%uus avg=%uus max=%uus (%u frames)\r\n",
+                      latency_last_us, latency_sum_us / latency_count, latency_max_us, latency_count);
+        latency_max_us = 0;
+        latency_sum_us = 0;
+        latency_count = 0;
+    }
+
+    pressure_windows = pressure ? pressure_windows + 1 : 0;
+    headroom_windows = headroom ? headroom_windows + 1 : 0;
+
+    if (pressure_windows >= PACER_DOWN_WINDOWS && quality < QUALITY_MINIMUM) {
+        setQuality((RENDER_QUALITY)(quality + 1));
+    } else if (headroom_windows >= PACER_UP_WINDOWS && quality > QUALITY_FULL) {
+        setQuality((RENDER_QUALITY)(quality - 1));
+    }
+
+    window_start = halMillis();
+    frames = 0;
+    pixels = 0;
+    pending_updates = 0;
+}
+
+void FramePacer::setQuality(RENDER_QUALITY level) {
+    quality = level;
+    pressure_windows = 0;
+    headroom_windows = 0;
+
+    if (disp) {
+        lv_timer_t* refr_timer = _lv_disp_get_refr_timer(disp);
+        if (refr_timer) {
+            lv_timer_set_period(refr_timer, framePeriod());
+        }
+    }
+
+    pacerPrintLog("Render quality -> %s (%ums)\r\n", qualityNames[level], framePeriod());
+}
@@ -0,0 +1,125 @@
+#ifdef ARDUINO
+
+#include <Arduino.h>
+#include <lwip/sockets.h>
+#include <TFT_eSPI.h>
+#include <SPI.h>
+#include <XPT2046_Touchscreen.h>
+#include "hal.h"
+#include "config.h"
+
+// 背光PWM
+#ifndef BACKLIGHT_PIN
+#define BACKLIGHT_PIN 21
+#endif
+#define BACKLIGHT_CHANNEL 0
+#define BACKLIGHT_PWM_FREQ 5000
+#define BACKLIGHT_PWM_BITS 8
+
+// 触摸校准 (XPT2046原始值范围), 可在config.h中覆盖
+#ifndef TOUCH_X_MIN
+#define TOUCH_X_MIN 200
+#endif
+#ifndef TOUCH_X_MAX
+#define TOUCH_X_MAX 3700
+#endif
+#ifndef TOUCH_Y_MIN
+#define TOUCH_Y_MIN 240
+#endif
+#ifndef TOUCH_Y_MAX
+#define TOUCH_Y_MAX 3800
+#endif
+
+static TFT_eSPI tft;
+
+// ESP32-2432S028R的触摸芯片挂在独立的SPI总线上; TFT_eSPI用 USE_HSPI_PORT 占用HSPI, 触摸使用VSPI
+static SPIClass touchSpi(VSPI);
+static XPT2046_Touchscreen touchScreen(XPT2046_CS, XPT2046_IRQ);
+
+uint32_t halMillis(void)
+{
+    return millis();
+}
+
+uint32_t halMicros(void)
+{
+    return micros();
+}
+
+void halSetCpuMhz(uint32_t mhz)
+{
+    setCpuFrequencyMhz(mhz);
+}
+
+uint32_t halFreeHeap(void)
+{
+    return ESP.getFreeHeap();
+}
+
+void halLogWrite(const char *data, size_t len)
+{
+    Serial.write((const uint8_t *)data, len);
+}
+
+int halRecv(int fd, void *buf, size_t len)
+{
+    return recv(fd, buf, len, 0);
+}
+
+void halDisplayInit(void)
+{
+    tft.init();
+    tft.setSwapBytes(false);
+
+    // 背光改为PWM控制, 由电源状态机调节亮度
+    ledcSetup(BACKLIGHT_CHANNEL, BACKLIGHT_PWM_FREQ, BACKLIGHT_PWM_BITS);
+    ledcAttachPin(BACKLIGHT_PIN, BACKLIGHT_CHANNEL);
+
+    touchSpi.begin(XPT2046_CLK, XPT2046_MISO, XPT2046_MOSI, XPT2046_CS);
+    touchScreen.begin(touchSpi);
+}
+
+void halDisplayRotate(int rotation)
+{
+    tft.setRotation(rotation);
+    touchScreen.setRotation(rotation);
+}
+
+// 旋转由面板MADCTL (setRotation) 完成, 刷新路径不做任何像素重排
+
+// LVGL已按面板字节序 (大端RGB565) 渲染, 整块原样推送
+void halDisplayFlushPreswapped(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint16_t *pixels)
+{
+    tft.startWrite();
+    tft.setAddrWindow(x, y, w, h);
+    tft.pushPixels(pixels, w * h);
+    tft.endWrite();
+}
+
+// 主机字节序, 只能由TFT_eSPI在发送时逐像素交换字节
+void halDisplayFlushSwap(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint16_t *pixels)
+{
+    tft.startWrite();
+    tft.setAddrWindow(x, y, w, h);
+    tft.pushColors((uint16_t *)pixels, w * h, true);
+    tft.endWrite();
+}
+
+void halBacklight(uint8_t level)
+{
+    ledcWrite(BACKLIGHT_CHANNEL, level);
+}
+
+bool halTouchRead(int16_t *x, int16_t *y)
+{
+    if (!touchScreen.tirqTouched() || !touchScreen.touched()) {
+        return false;
+    }
+
+    TS_Point point = touchScreen.getPoint();
+    *x = constrain(map(point.x, TOUCH_X_MIN, TOUCH_X_MAX, 0, MAX_X - 1), 0, MAX_X - 1);
+    *y = constrain(map(point.y, TOUCH_Y_MIN, TOUCH_Y_MAX, 0, MAX_Y - 1), 0, MAX_Y - 1);
+    return true;
+}
+
+#endif
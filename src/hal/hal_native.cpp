@@ -0,0 +1,118 @@
+#ifndef ARDUINO
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "hal.h"
+#include "config.h"
+
+// 横屏尺寸, 竖屏时宽高互换
+static uint16_t framebuffer[MAX_X * MAX_Y];
+static uint32_t fbWidth = MAX_X;
+static uint32_t fbHeight = MAX_Y;
+static uint64_t startUs = 0;
+static bool virtualClock = false;
+static uint32_t virtualMs = 0;
+
+static uint64_t monotonicUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// 与Arduino一样从启动开始计时
+uint32_t halMillis(void)
+{
+    if (virtualClock) {
+        return virtualMs;
+    }
+    return (uint32_t)((monotonicUs() - startUs) / 1000);
+}
+
+uint32_t halMicros(void)
+{
+    return (uint32_t)(monotonicUs() - startUs);
+}
+
+void halUseVirtualClock(void)
+{
+    virtualClock = true;
+}
+
+void halAdvanceMillis(uint32_t ms)
+{
+    virtualMs += ms;
+}
+
+void halSetCpuMhz(uint32_t mhz)
+{
+}
+
+uint32_t halFreeHeap(void)
+{
+    return 0;
+}
+
+void halLogWrite(const char *data, size_t len)
+{
+    fwrite(data, 1, len, stderr);
+}
+
+int halRecv(int fd, void *buf, size_t len)
+{
+    return read(fd, buf, len);
+}
+
+void halDisplayInit(void)
+{
+    startUs = monotonicUs() - 1000;
+    virtualMs = 1;
+    memset(framebuffer, 0, sizeof(framebuffer));
+}
+
+void halDisplayRotate(int rotation)
+{
+    fbWidth = (rotation & 1) ? MAX_X : MAX_Y;
+    fbHeight = (rotation & 1) ? MAX_Y : MAX_X;
+}
+
+// 与面板一致, 帧缓冲区统一保存为大端RGB565
+void halDisplayFlushPreswapped(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint16_t *pixels)
+{
+    for (uint32_t row = 0; row < h; row++) {
+        memcpy(framebuffer + (y + row) * fbWidth + x, pixels + row * w, w * sizeof(uint16_t));
+    }
+}
+
+void halDisplayFlushSwap(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint16_t *pixels)
+{
+    for (uint32_t row = 0; row < h; row++) {
+        uint16_t *dst = framebuffer + (y + row) * fbWidth + x;
+        const uint16_t *src = pixels + row * w;
+
+        for (uint32_t col = 0; col < w; col++) {
+            dst[col] = (uint16_t)((src[col] >> 8) | (src[col] << 8));
+        }
+    }
+}
+
+void halBacklight(uint8_t level)
+{
+}
+
+bool halTouchRead(int16_t *x, int16_t *y)
+{
+    return false;
+}
+
+const uint16_t *halFramebuffer(uint32_t *width, uint32_t *height)
+{
+    *width = fbWidth;
+    *height = fbHeight;
+    return framebuffer;
+}
+
+#endif
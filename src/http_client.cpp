@@ -1,13 +1,244 @@
 #include "http_client.h"
-#include <lwip/sockets.h>
 #include "config.h"
-#include "display.h"
-#include <regex>
-
-#define DISPLAY_AIDA64_DATA(data) display_enhanced.displayAida64Data(data)
+#include <mutex>
+#include "hal.h"
+#include "metrics.h"
+#include "trace.h"
+#include "alloc_track.h"
+#include "wifi_power.h"
+#include "aida64_binary.h"
+#ifdef COMPANION_MULTICAST
+#include <lwip/sockets.h>
+#endif
 
-char httpDataBuffer[4096];
 std::vector<AIDA64_DATA> aida64DataList;
+static AIDA64_STREAM sseStream;
+
+// 待显示的数据帧, 由HTTP任务发布, 显示任务取走; HTTP任务不直接操作LVGL
+static std::vector<AIDA64_DATA> pendingFrame;
+static uint32_t pendingArrivalUs = 0;
+static bool framePending = false;
+static std::mutex frameMutex;
+static TaskHandle_t frameListener = NULL;
+
+void setAida64FrameListener(TaskHandle_t task)
+{
+    frameListener = task;
+}
+
+void publishAida64Frame(const std::vector<AIDA64_DATA> &dataList, uint32_t arrivalUs)
+{
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        // 显示任务还没取走上一帧时直接覆盖, 只显示最新数据
+        if (!framePending) {
+            pendingArrivalUs = arrivalUs;
+        } else {
+            metricsInc(METRIC_FRAMES_DROPPED);
+        }
+        pendingFrame = dataList;
+        framePending = true;
+    }
+
+    // 唤醒显示任务, 不必等到下一个轮询周期
+    if (frameListener != NULL) {
+        xTaskNotifyGive(frameListener);
+    }
+}
+
+bool takeAida64Frame(std::vector<AIDA64_DATA> &dataList, uint32_t *arrivalUs)
+{
+    std::lock_guard<std::mutex> lock(frameMutex);
+
+    if (!framePending) {
+        return false;
+    }
+
+    dataList.swap(pendingFrame);
+    *arrivalUs = pendingArrivalUs;
+    framePending = false;
+    return true;
+}
+
+// 解析出的数据帧交给显示任务
+static void deliverFrame(uint32_t arrivalUs)
+{
+    metricsInc(METRIC_FRAMES_RECEIVED);
+    wifiPowerPolicy.onFrame(arrivalUs);
+    publishAida64Frame(aida64DataList, arrivalUs);
+}
+
+#if defined(COMPANION_HOST) || defined(COMPANION_MULTICAST)
+static AIDA64_BIN_DECODER binaryDecoder;
+static std::vector<AIDA64_LAYOUT_ITEM> binaryLayout;
+
+// 取出流缓冲区中的完整帧, 在接收缓冲区中原地解码, 不复制
+static void handleBinaryFrames(uint32_t arrivalUs)
+{
+    AIDA64_BIN_FRAME frame;
+    uint32_t assemblyStartUs = arrivalUs;
+
+    while (aida64BinaryNextFrame(sseStream, frame)) {
+        uint32_t parseStartUs = halMicros();
+        metricsStage(STAGE_ASSEMBLY, parseStartUs - assemblyStartUs);
+
+        if (frame.type == AIDA64_BIN_LAYOUT) {
+            // 中继会重发相同的布局, 只有变化时才有预期内的分配
+            if (aida64BinaryLayoutChanged(binaryDecoder, frame)) {
+                allocRestartWarmup();
+            }
+            if (aida64BinaryDecodeLayout(binaryDecoder, frame, binaryLayout)) {
+                publishAida64Layout(binaryLayout);
+            }
+            assemblyStartUs = halMicros();
+            continue;
+        }
+
+        bool decoded = aida64BinaryDecodeData(binaryDecoder, frame, aida64DataList);
+        assemblyStartUs = halMicros();
+        metricsStage(STAGE_PARSE, assemblyStartUs - parseStartUs);
+        metricsObserve(METRIC_PARSE_US, assemblyStartUs - parseStartUs);
+
+        if (decoded && !aida64DataList.empty()) {
+            deliverFrame(arrivalUs);
+        }
+    }
+}
+#endif
+
+#ifdef COMPANION_HOST
+// 二进制协议: 连接Linux上的伴随程序 (中继), 布局和数据都来自这一个连接, 不再访问AIDA64
+static void runCompanionClient()
+{
+    while (1)
+    {
+        while (WiFi.status() != WL_CONNECTED)
+        {
+            httpPrintLog("WiFi not connected, waiting...\r\n");
+            delay(2000);
+        }
+
+        WiFiClient client;
+        if (!client.connect(COMPANION_HOST, COMPANION_PORT)) {
+            httpPrintLog("Companion %s:%d not reachable\r\n", COMPANION_HOST, COMPANION_PORT);
+            delay(5000);
+            continue;
+        }
+        client.setNoDelay(true);
+        httpPrintLog("Connected to companion %s:%d\r\n", COMPANION_HOST, COMPANION_PORT);
+
+        aida64StreamReset(sseStream);
+        aida64BinaryDecoderReset(binaryDecoder);
+        int fd = client.fd();
+
+        while (1)
+        {
+            size_t space;
+            char *writePtr = aida64StreamWritePtr(sseStream, &space);
+            uint32_t recvStartUs = halMicros();
+            int recv_len;
+            {
+                TRACE_SCOPE(TRACE_HTTP_RECV);
+                ALLOC_STAGE(STAGE_RECV);
+                recv_len = halRecv(fd, writePtr, space);
+            }
+
+            if (recv_len <= 0)
+            {
+                httpPrintLog("Companion connection closed, recv_len: %d\n", recv_len);
+                break;
+            }
+
+            uint32_t arrivalUs = halMicros();
+            TRACE_SCOPE(TRACE_HTTP_FRAME);
+            ALLOC_STAGE(STAGE_ASSEMBLY);
+            metricsStage(STAGE_RECV, arrivalUs - recvStartUs);
+            aida64StreamCommit(sseStream, recv_len);
+            handleBinaryFrames(arrivalUs);
+        }
+
+        client.stop();
+        metricsInc(METRIC_SSE_RECONNECTS);
+        delay(2000);
+    }
+}
+#endif
+
+#ifdef COMPANION_MULTICAST
+// 组播: 中继的每个数据报是一个完整的帧, 关键帧之前带有布局; 丢失的数据报由下一个关键帧恢复
+static void runMulticastClient()
+{
+    struct timeval timeout = {COMPANION_MULTICAST_TIMEOUT_MS / 1000, (COMPANION_MULTICAST_TIMEOUT_MS % 1000) * 1000};
+    struct sockaddr_in addr;
+    struct ip_mreq mreq;
+
+    while (1)
+    {
+        while (WiFi.status() != WL_CONNECTED)
+        {
+            httpPrintLog("WiFi not connected, waiting...\r\n");
+            delay(2000);
+        }
+
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0) {
+            httpPrintLog("Multicast socket failed\r\n");
+            delay(5000);
+            continue;
+        }
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(COMPANION_PORT);
+        mreq.imr_multiaddr.s_addr = inet_addr(COMPANION_MULTICAST);
+        mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+        if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+            setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) {
+            httpPrintLog("Joining %s:%d failed\r\n", COMPANION_MULTICAST, COMPANION_PORT);
+            close(fd);
+            delay(5000);
+            continue;
+        }
+        // 超时后重新加入: WiFi重连后组成员关系会丢失
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        httpPrintLog("Joined multicast group %s:%d\r\n", COMPANION_MULTICAST, COMPANION_PORT);
+
+        aida64BinaryDecoderReset(binaryDecoder);
+
+        while (1)
+        {
+            // 数据报之间没有跨包的帧, 每次从空缓冲区开始
+            aida64StreamReset(sseStream);
+            size_t space;
+            char *writePtr = aida64StreamWritePtr(sseStream, &space);
+            uint32_t recvStartUs = halMicros();
+            int recv_len;
+            {
+                TRACE_SCOPE(TRACE_HTTP_RECV);
+                ALLOC_STAGE(STAGE_RECV);
+                recv_len = halRecv(fd, writePtr, space);
+            }
+
+            if (recv_len <= 0)
+            {
+                httpPrintLog("No multicast data for %d ms, rejoining\r\n", COMPANION_MULTICAST_TIMEOUT_MS);
+                break;
+            }
+
+            uint32_t arrivalUs = halMicros();
+            TRACE_SCOPE(TRACE_HTTP_FRAME);
+            ALLOC_STAGE(STAGE_ASSEMBLY);
+            metricsStage(STAGE_RECV, arrivalUs - recvStartUs);
+            aida64StreamCommit(sseStream, recv_len);
+            handleBinaryFrames(arrivalUs);
+        }
+
+        close(fd);
+        metricsInc(METRIC_SSE_RECONNECTS);
+    }
+}
+#endif
 
 void taskHttpClient(void *param)
 {
@@ -17,8 +248,15 @@ void taskHttpClient(void *param)
     delay(5000);
     httpPrintLog("Starting HTTP client after delay\r\n");
     
+#if defined(COMPANION_MULTICAST)
+    runMulticastClient();
+#elif defined(COMPANION_HOST)
+    runCompanionClient();
+#endif
+    
     // 首先做一个简单的连接测试
     bool connectionTested = false;
+    bool layoutDiscovered = false;
     while(!connectionTested)
     {
         httpPrintLog("Checking WiFi status: %d\r\n", WiFi.status());
@@ -32,30 +270,8 @@ void taskHttpClient(void *param)
         
         httpPrintLog("WiFi connected, testing basic HTTP connection...\r\n");
         
-        // 简单的HTTP GET测试
-        HTTPClient httpClient;
-        String testUrl = "http://" + String(HTTP_HOST) + ":" + String(HTTP_PORT) + "/";
-        
-        httpPrintLog("Testing connection to: %s\r\n", testUrl.c_str());
-        
-        httpClient.begin(testUrl);
-        int httpCode = httpClient.GET();
-        
-        httpPrintLog("HTTP GET result: %d\r\n", httpCode);
-        
-        if(httpCode > 0) {
-            String payload = httpClient.getString();
-            httpPrintLog("Received %d bytes\r\n", payload.length());
-            
-            if(payload.length() > 0) {
-                httpPrintLog("Basic connection test successful!\r\n");
-                connectionTested = true;
-            }
-        } else {
-            httpPrintLog("HTTP GET failed: %s\r\n", httpClient.errorToString(httpCode).c_str());
-        }
-        
-        httpClient.end();
+        // 首次连接测试同时完成布局发现
+        connectionTested = discoverAida64Layout();
         
         if(!connectionTested) {
             httpPrintLog("Retrying basic connection test in 10 seconds...\r\n");
@@ -64,6 +280,7 @@ void taskHttpClient(void *param)
     }
     
     httpPrintLog("Basic connection test completed, starting SSE...\r\n");
+    layoutDiscovered = true;
     
     // 现在开始正常的SSE连接循环
     while(1)
@@ -92,6 +309,12 @@ void taskHttpClient(void *param)
             continue;
         }
 
+        // 每次建立连接前获取一次页面, 布局哈希变化时显示侧才会重建
+        if (!layoutDiscovered) {
+            discoverAida64Layout();
+        }
+        layoutDiscovered = false;
+
         // SSE连接
         String sseUrl = "http://" + String(HTTP_HOST) + ":" + String(HTTP_PORT) + "/sse";
         httpClient.begin(sseUrl);
@@ -104,6 +327,7 @@ void taskHttpClient(void *param)
         if(httpCode == HTTP_CODE_OK)
         {
             httpPrintLog("SSE connection established successfully\n");
+            aida64StreamReset(sseStream);
 
             while (1)
             {
@@ -119,7 +343,14 @@ void taskHttpClient(void *param)
                     break;
                 }
                 
-                recv_len = recv(fd, httpDataBuffer, 1024, 0);
+                size_t space;
+                char *writePtr = aida64StreamWritePtr(sseStream, &space);
+                uint32_t recvStartUs = halMicros();
+                {
+                    TRACE_SCOPE(TRACE_HTTP_RECV);
+                    ALLOC_STAGE(STAGE_RECV);
+                    recv_len = halRecv(fd, writePtr, space);
+                }
 
                 if(recv_len <= 0)
                 {
@@ -127,15 +358,30 @@ void taskHttpClient(void *param)
                     break;
                 }
 
-                httpDataBuffer[recv_len] = '\0';
-                httpPrintLog("Received %d bytes: %s\n", recv_len, httpDataBuffer);
+                uint32_t arrivalUs = halMicros();
+                TRACE_SCOPE(TRACE_HTTP_FRAME);
+                ALLOC_STAGE(STAGE_ASSEMBLY);
+                metricsStage(STAGE_RECV, arrivalUs - recvStartUs);
+                aida64StreamCommit(sseStream, recv_len);
+                httpDebugLog("Received %d bytes: %s\n", recv_len, writePtr);
 
-                //parse data
-                parseAida64Data(httpDataBuffer, aida64DataList);
-                
-                //display data if we have any
-                if (!aida64DataList.empty()) {
-                    DISPLAY_AIDA64_DATA(aida64DataList);
+                // 帧组装: 一个SSE事件可能跨多次recv, 按完整的 "data:" 行处理
+                char *event;
+                uint32_t assemblyStartUs = arrivalUs;
+                while ((event = aida64StreamNextEvent(sseStream)) != NULL) {
+                    uint32_t parseStartUs = halMicros();
+                    metricsStage(STAGE_ASSEMBLY, parseStartUs - assemblyStartUs);
+
+                    //parse data
+                    parseAida64Data(event, aida64DataList);
+                    assemblyStartUs = halMicros();
+                    metricsStage(STAGE_PARSE, assemblyStartUs - parseStartUs);
+                    metricsObserve(METRIC_PARSE_US, assemblyStartUs - parseStartUs);
+
+                    //hand the frame over to the display task
+                    if (!aida64DataList.empty()) {
+                        deliverFrame(arrivalUs);
+                    }
                 }
             }
         }
@@ -146,141 +392,44 @@ void taskHttpClient(void *param)
         }
 
         httpClient.end();
+        metricsInc(METRIC_SSE_RECONNECTS);
         httpPrintLog("SSE connection ended, retrying in 10 seconds\r\n");
         delay(10000);
     }
 }
 
-void parseAida64HTML(char *htmlData, std::vector<AIDA64_DATA> &dataList)
+bool discoverAida64Layout()
 {
-    /*
-     * 接收到的HTML有如下结构
-     * ...
-     * <body onload="MyOnLoad()">
-     * <div id="page0">
-     * <span id="xxx1" ...>XXX</span>
-     * <span id="xxx2" ...>XXX</span>
-     * ...
-     * <span id="xxxn" ...>XXX</span>
-     * </div>
-     * </body>
-     * ...
-     * 其中span标签的内容即是在AIDA64中设置的LCD项目，需要将id和内容提取出来，保存在adia64DataList中
-     * 之后会发送请求获取刷新数据，通过对比id，修改adia64DataList中对应的值
-     */
-    
-    AIDA64_DATA data = {0};
-    std::string input(htmlData);
-
-    aida64DataList.clear();
-    httpPrintLog("htmlData:\r\n%s\r\n", htmlData);
-
-    // 定义正则表达式
-    std::regex pattern("<span id=\"(.*?)\".*?>(.*?)<\\/span>");
-
-    // 搜索匹配项
-    std::sregex_iterator it(input.begin(), input.end(), pattern);
-    std::sregex_iterator end;
-    
-    while (it != end) {
-        // 提取匹配的子串
-        std::smatch match = *it;
-        httpPrintLog("match: %s, %s\r\n", match[1].str().c_str(), match[2].str().c_str());
-
-        // 加入aida64DataList
-        strcpy(data.id, match[1].str().c_str());
-        strcpy(data.val, match[2].str().c_str());
-        aida64DataList.push_back(data);
+    HTTPClient httpClient;
+    std::vector<AIDA64_LAYOUT_ITEM> layout;
+    String url = "http://" + String(HTTP_HOST) + ":" + String(HTTP_PORT) + "/";
+    bool discovered = false;
 
-        ++it;
-    }
+    httpPrintLog("Discovering layout from: %s\r\n", url.c_str());
 
-    return;
-}
+    httpClient.begin(url);
+    int httpCode = httpClient.GET();
 
-void parseAida64Data(char *src, std::vector<AIDA64_DATA> &dataList)
-{
-    /* 
-     * AIDA64会回复以下格式的响应体:
-     * data: Page0|{|}Simple2|2:55:48{|}Simple4|3%{|}Simple5|1097MHz{|}Simple6|40°C{|}...
-     * 需要将数据从字符串中提取出来
-     */
-    
-    AIDA64_DATA data = {0};
-    std::string input(src);
+    httpPrintLog("HTTP GET result: %d\r\n", httpCode);
 
-    httpPrintLog("SSE Data received:\r\n%s\r\n", src);
+    if (httpCode > 0) {
+        String payload = httpClient.getString();
+        httpPrintLog("Received %u bytes\r\n", (unsigned)payload.length());
 
-    // 首先检查是否包含 "data:" 开头的SSE数据
-    size_t dataPos = input.find("data:");
-    if (dataPos == std::string::npos) {
-        return; // 不是有效的SSE数据
-    }
+        parseAida64Layout(payload.c_str(), layout);
 
-    // 提取 data: 后面的内容
-    std::string dataLine = input.substr(dataPos + 5); // 跳过 "data:"
-    
-    // 清空现有数据列表以准备新数据
-    dataList.clear();
-
-    // 解析数据格式：Page0|{|}Simple2|2:55:48{|}Simple4|3%{|}...
-    size_t pos = 0;
-    bool skipFirst = true; // 跳过第一个 Page0|{|}
-    
-    while (pos < dataLine.length()) {
-        // 查找下一个分隔符 {|}
-        size_t delimPos = dataLine.find("{|}", pos);
-        if (delimPos == std::string::npos) {
-            break; // 没有更多数据
+        if (!layout.empty()) {
+            publishAida64Layout(layout);
+            discovered = true;
+        } else if (payload.length() > 0) {
+            // 页面可访问但没有span, 保留当前布局继续使用
+            httpPrintLog("No LCD items found in page, keeping current layout\r\n");
+            discovered = true;
         }
-        
-        // 提取这一段：例如 "Simple2|2:55:48"
-        std::string segment = dataLine.substr(pos, delimPos - pos);
-        
-        if (!skipFirst && !segment.empty()) {
-            // 在段中查找 | 分隔符
-            size_t pipePos = segment.find('|');
-            if (pipePos != std::string::npos) {
-                std::string id = segment.substr(0, pipePos);
-                std::string value = segment.substr(pipePos + 1);
-                
-                // 移除value中的多余字符
-                strremove(const_cast<char*>(value.c_str()), ' ');
-                
-                // 将解析的数据添加到列表
-                memset(&data, 0, sizeof(data));
-                strncpy(data.id, id.c_str(), sizeof(data.id) - 1);
-                strncpy(data.val, (">" + value).c_str(), sizeof(data.val) - 1);
-                
-                dataList.push_back(data);
-                
-                httpPrintLog("Parsed: ID=%s, Value=%s\n", data.id, data.val);
-            }
-        }
-        
-        skipFirst = false;
-        pos = delimPos + 3; // 跳过 {|}
+    } else {
+        httpPrintLog("HTTP GET failed: %s\r\n", httpClient.errorToString(httpCode).c_str());
     }
 
-    httpPrintLog("Total parsed items: %d\n", dataList.size());
-    return;
-}
-
-void strremove(char* src, char remove)
-{
-    char* c = src;
-
-    do
-    {
-        if(*c == remove)
-        {
-            c++;
-        }
-
-        *src = *c;
-        src++;
-        c++;
-    } while (*c != '\0');
-    
-    *src = '\0';
+    httpClient.end();
+    return discovered;
 }
@@ -0,0 +1,143 @@
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+#include <atomic>
+#include <stdarg.h>
+#include <stdio.h>
+#include "hal.h"
+#include "log.h"
+#include "metrics.h"
+
+#define LOG_TASK_STACK 3072
+#define LOG_TASK_PRIORITY 1
+#define LOG_WINDOW_MS 1000
+
+static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS must be a power of 2");
+
+typedef struct
+{
+    std::atomic<uint8_t> ready;
+    uint8_t len;
+    char text[LOG_LINE_SIZE];
+} LOG_SLOT;
+
+// 多生产者单消费者: 生产者用CAS抢占head, 写完后置ready; 输出任务按tail顺序取
+static LOG_SLOT logRing[LOG_RING_SLOTS];
+static std::atomic<uint32_t> logHead(0);
+static std::atomic<uint32_t> logTail(0);
+#ifdef ARDUINO
+static TaskHandle_t logTask = NULL;
+#endif
+
+static bool logDrainOne();
+
+static void logPush(const char *format, va_list args)
+{
+    uint32_t head = logHead.load(std::memory_order_relaxed);
+    int len;
+
+    do {
+        if (head - logTail.load(std::memory_order_acquire) >= LOG_RING_SLOTS) {
+            // 缓冲区满时丢弃新行, 不阻塞调用方
+            metricsInc(METRIC_LOG_DROPPED);
+            return;
+        }
+    } while (!logHead.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel));
+
+    LOG_SLOT &slot = logRing[head & (LOG_RING_SLOTS - 1)];
+    len = vsnprintf(slot.text, sizeof(slot.text), format, args);
+    if (len < 0) len = 0;
+    if (len >= (int)sizeof(slot.text)) len = sizeof(slot.text) - 1;
+    slot.len = len;
+    slot.ready.store(1, std::memory_order_release);
+
+#ifdef ARDUINO
+    if (logTask) {
+        xTaskNotifyGive(logTask);
+    }
+#else
+    // env:native没有输出任务, 直接同步输出
+    while (logDrainOne()) {
+    }
+#endif
+}
+
+void logWrite(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    logPush(format, args);
+    va_end(args);
+}
+
+static void logPrintf(const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    logPush(format, args);
+    va_end(args);
+}
+
+bool logAllow(LOG_LIMIT *limit)
+{
+    uint32_t now = halMillis();
+
+    if (now - limit->window_start >= LOG_WINDOW_MS) {
+        if (limit->suppressed > 0) {
+            logPrintf("\r\n[LOG] %u lines suppressed\r\n", limit->suppressed);
+        }
+        limit->window_start = now;
+        limit->count = 0;
+        limit->suppressed = 0;
+    }
+
+    if (limit->count < LOG_RATE_LIMIT) {
+        limit->count++;
+        return true;
+    }
+
+    if (limit->suppressed < UINT16_MAX) limit->suppressed++;
+    metricsInc(METRIC_LOG_SUPPRESSED);
+    return false;
+}
+
+// 输出tail处的一行, 没有可输出的行时返回false
+static bool logDrainOne()
+{
+    uint32_t tail = logTail.load(std::memory_order_relaxed);
+    LOG_SLOT &slot = logRing[tail & (LOG_RING_SLOTS - 1)];
+
+    // 生产者已抢占但尚未写完的槽同样需要等待
+    if (tail == logHead.load(std::memory_order_acquire) ||
+        !slot.ready.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    halLogWrite(slot.text, slot.len);
+    slot.ready.store(0, std::memory_order_relaxed);
+    logTail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+#ifdef ARDUINO
+static void taskLogWriter(void *param)
+{
+    while (1)
+    {
+        if (!logDrainOne()) {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+        }
+    }
+}
+
+void logBegin()
+{
+    xTaskCreate(taskLogWriter, "log_writer", LOG_TASK_STACK, NULL, LOG_TASK_PRIORITY, &logTask);
+}
+#else
+void logBegin()
+{
+}
+#endif
@@ -4,17 +4,25 @@
 #include "config.h"
 #include "wifi_client.h"
 #include "time_manager.h"
+#include "power_manager.h"
+#include "metrics.h"
+#include "trace.h"
+#include "warm_cache.h"
+#include "alloc_track.h"
 
 /* default config */
 int screen_dir = SCREEN_DIR_HORIZONTAL;
-static unsigned long last_data_update = 0;
-static unsigned long last_time_update = 0;
+static std::vector<AIDA64_DATA> displayFrame;
+static int32_t last_clock_second = -2;
+static uint32_t loop_wait = 1;
 
 void setup()
 {
     // put your setup code here, to run once:
     //Serial
     Serial.begin(115200);
+    logBegin();
+    allocTrackBegin();
     UARTPrintf("[SYSTEM] Initial start...\r\n");
 
     //Display
@@ -23,13 +31,28 @@ void setup()
     display_enhanced.begin(screen_dir);
     UARTPrintf("[ENHANCED DISPLAY] Init finish\r\n");
     display_enhanced.clear();
+    powerManager.begin();
+
+    // 数据到达时由HTTP任务唤醒loop()
+    setAida64FrameListener(xTaskGetCurrentTaskHandle());
 
     // thread
-    BaseType_t wifiTaskResult = xTaskCreate(taskWifiClient, "taskWifiClient", 4096, NULL, 2, NULL);
-    BaseType_t httpTaskResult = xTaskCreate(taskHttpClient, "taskHttpClient", 8192, NULL, 2, NULL);
+    TaskHandle_t wifiTask = NULL;
+    TaskHandle_t httpTask = NULL;
+    TaskHandle_t metricsTask = NULL;
+    BaseType_t wifiTaskResult = xTaskCreate(taskWifiClient, "taskWifiClient", 4096, NULL, 2, &wifiTask);
+    BaseType_t httpTaskResult = xTaskCreate(taskHttpClient, "taskHttpClient", 8192, NULL, 2, &httpTask);
+    BaseType_t metricsTaskResult = xTaskCreate(taskMetricsServer, "taskMetricsServer", 4096, NULL, 1, &metricsTask);
     
     UARTPrintf("[SYSTEM] WiFi task creation: %s\r\n", wifiTaskResult == pdPASS ? "SUCCESS" : "FAILED");
     UARTPrintf("[SYSTEM] HTTP task creation: %s\r\n", httpTaskResult == pdPASS ? "SUCCESS" : "FAILED");
+    UARTPrintf("[SYSTEM] Metrics task creation: %s\r\n", metricsTaskResult == pdPASS ? "SUCCESS" : "FAILED");
+    
+    // 上报各任务的栈水位
+    metricsRegisterTask("loop", xTaskGetCurrentTaskHandle());
+    metricsRegisterTask("wifi", wifiTask);
+    metricsRegisterTask("http", httpTask);
+    metricsRegisterTask("metrics", metricsTask);
     
     // 等待WiFi连接后初始化时间同步
     UARTPrintf("[SYSTEM] Waiting for WiFi connection before NTP sync...\r\n");
@@ -40,7 +63,14 @@ void setup()
 
 void loop()
 {
-    unsigned long current_time = millis();
+    // 等待新数据到达或LVGL定时器到期, 数据到达时立即被唤醒
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(loop_wait));
+    TRACE_SCOPE(TRACE_LOOP);
+    
+    // 串口收到 't' 时导出跟踪缓冲区
+    if (Serial.available() && Serial.read() == 't') {
+        traceDumpSerial();
+    }
     
     // 检查WiFi连接状态并初始化NTP时间同步
     static bool ntp_initialized = false;
@@ -52,23 +82,29 @@ void loop()
     // 定期检查时间同步
     timeManager.checkAndSyncTime();
     
-    // 增强显示模式
-    // Handle LVGL tasks (更频繁的刷新)
-    display_enhanced.tick();
-    
-    // Update AIDA64 data display
-    if (!aida64DataList.empty() && 
-        (current_time - last_data_update >= 1000)) { // 1秒更新间隔
-        display_enhanced.displayAida64Data(aida64DataList);
-        last_data_update = current_time;
+    // Update AIDA64 data display (数据到达即应用, 不再等1秒节拍)
+    uint32_t arrival_us = 0;
+    if (takeAida64Frame(displayFrame, &arrival_us)) {
+        // 先唤醒 (恢复渲染和背光), 本帧数据即可立即显示
+        powerManager.onDataArrived();
+        display_enhanced.displayAida64Data(displayFrame, arrival_us);
+        warmCacheUpdate(displayFrame);
     }
     
-    // Update time display
-    if (current_time - last_time_update >= TIME_UPDATE_INTERVAL) {
-        display_enhanced.updateTimeDisplay(timeManager.getCurrentTimeString());
-        last_time_update = current_time;
+    // 输出稳态后新出现的堆分配 (仅 ALLOC_TRACK 构建)
+    allocCheck();
+    
+    // 根据数据新鲜度切换电源状态
+    powerManager.service();
+    
+    // Update time display, 秒数变化时重绘, 与数据更新合并在同一帧
+    int32_t clock_second = timeManager.getSecondsOfDay();
+    if (clock_second != last_clock_second) {
+        display_enhanced.updateClock(clock_second);
+        last_clock_second = clock_second;
     }
     
-    delay(5); // 减少延迟，更频繁的LVGL处理
+    // 增强显示模式
+    // Handle LVGL tasks, 返回距离下一个LVGL定时器的时间
+    loop_wait = powerManager.adjustWait(display_enhanced.tick());
 }
-
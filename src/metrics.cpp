@@ -0,0 +1,394 @@
+#include "metrics.h"
+#include <atomic>
+#ifdef ARDUINO
+#include <WiFi.h>
+#include "display.h"
+#include "power_manager.h"
+#include "trace.h"
+#include "time_manager.h"
+#include "wifi_client.h"
+#include "wifi_power.h"
+#include "alloc_track.h"
+#endif
+
+#define METRICS_MAX_TASKS 6
+#define METRICS_BUCKETS 11
+
+// 直方图桶上限 (微秒), 最后一个桶为 +Inf
+static const uint32_t bucketBounds[METRICS_BUCKETS - 1] = {
+    100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000,
+};
+#ifdef ARDUINO
+// 只有 /metrics 服务使用
+static const char *bucketLabels[METRICS_BUCKETS] = {
+    "0.0001", "0.00025", "0.0005", "0.001", "0.0025", "0.005", "0.01", "0.025", "0.05", "0.1", "+Inf",
+};
+#endif
+
+static const struct
+{
+    const char *name;
+    const char *help;
+} counterInfo[METRIC_COUNTER_MAX] = {
+    {"aida64_frames_received_total", "SSE data frames received and parsed"},
+    {"aida64_frames_dropped_total", "Frames overwritten before the display task consumed them"},
+    {"aida64_flush_areas_total", "Areas flushed to the panel"},
+    {"aida64_flush_pixels_total", "Pixels flushed to the panel"},
+    {"aida64_wifi_reconnects_total", "WiFi reconnect attempts"},
+    {"aida64_sse_reconnects_total", "SSE connections that ended and were retried"},
+    {"aida64_log_dropped_total", "Log lines dropped because the log ring buffer was full"},
+    {"aida64_log_suppressed_total", "Log lines dropped by per-call-site rate limiting"},
+    {"aida64_binding_updates_total", "Values parsed and applied to a binding"},
+    {"aida64_binding_updates_decimated_total", "Values skipped because their binding's update interval had not elapsed"},
+    {"aida64_widget_updates_total", "Bound widgets changed by a new value"},
+};
+
+static const struct
+{
+    const char *name;
+    const char *help;
+} histogramInfo[METRIC_HISTOGRAM_MAX] = {
+    {"aida64_parse_duration_seconds", "Time spent parsing one SSE frame"},
+    {"aida64_render_duration_seconds", "Time LVGL spent rendering and flushing one frame"},
+    {"aida64_data_to_flush_seconds", "Latency from data arrival to the end of the flush"},
+};
+
+typedef struct
+{
+    std::atomic<uint32_t> buckets[METRICS_BUCKETS];
+    // 32位微秒累计约4295秒后回绕, 而_count继续增长, 因此用64位
+#ifdef ARDUINO
+    uint64_t sum_us;                // Xtensa没有64位原子操作, 由histogramSumLock保护
+#else
+    std::atomic<uint64_t> sum_us;
+#endif
+    std::atomic<uint32_t> count;
+} METRIC_HISTOGRAM_DATA;
+
+typedef struct
+{
+    std::atomic<uint32_t> min_us;
+    std::atomic<uint32_t> max_us;
+    std::atomic<uint32_t> sum_us;
+    std::atomic<uint32_t> count;
+} METRIC_STAGE_DATA;
+
+static const char *stageNames[STAGE_MAX] = {
+    "recv",
+    "asm",
+    "parse",
+    "disp",
+    "render",
+    "flush",
+};
+
+static std::atomic<uint32_t> counters[METRIC_COUNTER_MAX];
+static METRIC_HISTOGRAM_DATA histograms[METRIC_HISTOGRAM_MAX];
+#ifdef ARDUINO
+static portMUX_TYPE histogramSumLock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+static METRIC_STAGE_DATA stages[STAGE_MAX];
+static std::atomic<uint32_t> poolFree(0);
+static std::atomic<uint32_t> poolLargest(0);
+static std::atomic<uint8_t> poolFrag(0);
+
+void metricsInc(METRIC_COUNTER counter, uint32_t n)
+{
+    counters[counter].fetch_add(n, std::memory_order_relaxed);
+}
+
+uint32_t metricsGet(METRIC_COUNTER counter)
+{
+    return counters[counter].load(std::memory_order_relaxed);
+}
+
+void metricsSetPool(const POOL_SNAPSHOT &pool)
+{
+    poolFree.store(pool.free_bytes, std::memory_order_relaxed);
+    poolLargest.store(pool.largest_free_bytes, std::memory_order_relaxed);
+    poolFrag.store(pool.frag_pct, std::memory_order_relaxed);
+}
+
+void metricsGetPool(POOL_SNAPSHOT &pool)
+{
+    pool.free_bytes = poolFree.load(std::memory_order_relaxed);
+    pool.largest_free_bytes = poolLargest.load(std::memory_order_relaxed);
+    pool.frag_pct = poolFrag.load(std::memory_order_relaxed);
+}
+
+void metricsObserve(METRIC_HISTOGRAM histogram, uint32_t value_us)
+{
+    METRIC_HISTOGRAM_DATA &data = histograms[histogram];
+    int bucket = 0;
+
+    while (bucket < METRICS_BUCKETS - 1 && value_us > bucketBounds[bucket]) {
+        bucket++;
+    }
+
+    data.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+#ifdef ARDUINO
+    portENTER_CRITICAL(&histogramSumLock);
+    data.sum_us += value_us;
+    portEXIT_CRITICAL(&histogramSumLock);
+#else
+    data.sum_us.fetch_add(value_us, std::memory_order_relaxed);
+#endif
+    data.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void metricsStage(PIPELINE_STAGE stage, uint32_t value_us)
+{
+    METRIC_STAGE_DATA &data = stages[stage];
+    uint32_t current;
+
+    // min为0表示窗口为空
+    current = data.min_us.load(std::memory_order_relaxed);
+    while ((current == 0 || value_us < current) &&
+           !data.min_us.compare_exchange_weak(current, value_us ? value_us : 1, std::memory_order_relaxed)) {
+    }
+
+    current = data.max_us.load(std::memory_order_relaxed);
+    while (value_us > current &&
+           !data.max_us.compare_exchange_weak(current, value_us, std::memory_order_relaxed)) {
+    }
+
+    data.sum_us.fetch_add(value_us, std::memory_order_relaxed);
+    data.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void metricsTakeStageWindow(PIPELINE_STAGE stage, STAGE_WINDOW &window)
+{
+    METRIC_STAGE_DATA &data = stages[stage];
+    uint32_t sum;
+
+    window.count = data.count.exchange(0, std::memory_order_relaxed);
+    sum = data.sum_us.exchange(0, std::memory_order_relaxed);
+    window.min_us = data.min_us.exchange(0, std::memory_order_relaxed);
+    window.max_us = data.max_us.exchange(0, std::memory_order_relaxed);
+    window.avg_us = window.count ? sum / window.count : 0;
+}
+
+const char *metricsStageName(PIPELINE_STAGE stage)
+{
+    return stageNames[stage];
+}
+
+// 以下为HTTP导出部分, 只在ESP32上编译; env:native只使用上面的无锁统计
+#ifdef ARDUINO
+static struct
+{
+    const char *name;
+    TaskHandle_t task;
+} tasks[METRICS_MAX_TASKS];
+static int taskCount = 0;
+
+void metricsRegisterTask(const char *name, TaskHandle_t task)
+{
+    if (task != NULL && taskCount < METRICS_MAX_TASKS) {
+        tasks[taskCount].name = name;
+        tasks[taskCount].task = task;
+        taskCount++;
+    }
+}
+
+static const char *wifiPathNames[WIFI_PATH_MAX] = {
+    "fast",
+    "scan",
+};
+
+static uint64_t histogramSum(const METRIC_HISTOGRAM_DATA &data)
+{
+    uint64_t sum_us;
+
+    portENTER_CRITICAL(&histogramSumLock);
+    sum_us = data.sum_us;
+    portEXIT_CRITICAL(&histogramSumLock);
+    return sum_us;
+}
+
+static void writeMetrics(WiFiClient &client)
+{
+    for (int i = 0; i < METRIC_COUNTER_MAX; i++) {
+        client.printf("# HELP %s %s\n# TYPE %s counter\n%s %u\n",
+                      counterInfo[i].name, counterInfo[i].help, counterInfo[i].name,
+                      counterInfo[i].name, counters[i].load(std::memory_order_relaxed));
+    }
+
+    for (int i = 0; i < METRIC_HISTOGRAM_MAX; i++) {
+        const char *name = histogramInfo[i].name;
+        uint32_t cumulative = 0;
+        uint64_t sum_us = histogramSum(histograms[i]);
+
+        client.printf("# HELP %s %s\n# TYPE %s histogram\n", name, histogramInfo[i].help, name);
+        for (int b = 0; b < METRICS_BUCKETS; b++) {
+            cumulative += histograms[i].buckets[b].load(std::memory_order_relaxed);
+            client.printf("%s_bucket{le=\"%s\"} %u\n", name, bucketLabels[b], cumulative);
+        }
+        // +Inf桶即总数, 保证scrape期间并发更新时count与桶一致
+        client.printf("%s_sum %llu.%06u\n%s_count %u\n", name, (unsigned long long)(sum_us / 1000000),
+                      (unsigned)(sum_us % 1000000), name, cumulative);
+    }
+
+    client.printf("# HELP aida64_heap_free_bytes Free heap\n# TYPE aida64_heap_free_bytes gauge\naida64_heap_free_bytes %u\n",
+                  ESP.getFreeHeap());
+    client.printf("# HELP aida64_heap_min_free_bytes Lowest free heap since boot\n# TYPE aida64_heap_min_free_bytes gauge\naida64_heap_min_free_bytes %u\n",
+                  ESP.getMinFreeHeap());
+    client.printf("# HELP aida64_heap_max_alloc_bytes Largest allocatable block\n# TYPE aida64_heap_max_alloc_bytes gauge\naida64_heap_max_alloc_bytes %u\n",
+                  ESP.getMaxAllocHeap());
+
+    // LVGL内存池: 控件文本改为静态缓冲区后, 长时间运行时这几项应保持平稳
+    // 本任务不能调用LVGL, 使用显示任务最近一次的采样
+    POOL_SNAPSHOT pool;
+    metricsGetPool(pool);
+    client.printf("# HELP aida64_lvgl_pool_free_bytes Free bytes in the LVGL memory pool\n# TYPE aida64_lvgl_pool_free_bytes gauge\naida64_lvgl_pool_free_bytes %u\n",
+                  pool.free_bytes);
+    client.printf("# HELP aida64_lvgl_pool_largest_free_bytes Largest free block in the LVGL memory pool\n# TYPE aida64_lvgl_pool_largest_free_bytes gauge\naida64_lvgl_pool_largest_free_bytes %u\n",
+                  pool.largest_free_bytes);
+    client.printf("# HELP aida64_lvgl_pool_fragmentation_ratio LVGL memory pool fragmentation\n# TYPE aida64_lvgl_pool_fragmentation_ratio gauge\naida64_lvgl_pool_fragmentation_ratio %u.%02u\n",
+                  pool.frag_pct / 100, pool.frag_pct % 100);
+
+#if ALLOC_TRACK
+    // 堆分配统计, stage="none" 为管线之外的分配
+    client.printf("# HELP aida64_allocations_total Heap and LVGL pool allocations per pipeline stage\n# TYPE aida64_allocations_total counter\n");
+    for (int stage = 0; stage <= STAGE_MAX; stage++) {
+        client.printf("aida64_allocations_total{stage=\"%s\"} %u\n",
+                      stage < STAGE_MAX ? metricsStageName((PIPELINE_STAGE)stage) : "none", allocGetCount((PIPELINE_STAGE)stage));
+    }
+    client.printf("# HELP aida64_lvgl_allocations_total LVGL memory pool allocations per pipeline stage (included in aida64_allocations_total)\n# TYPE aida64_lvgl_allocations_total counter\n");
+    for (int stage = 0; stage <= STAGE_MAX; stage++) {
+        client.printf("aida64_lvgl_allocations_total{stage=\"%s\"} %u\n",
+                      stage < STAGE_MAX ? metricsStageName((PIPELINE_STAGE)stage) : "none", allocGetLvglCount((PIPELINE_STAGE)stage));
+    }
+    client.printf("# HELP aida64_steady_allocations_total Heap and LVGL pool allocations per pipeline stage after warm-up\n# TYPE aida64_steady_allocations_total counter\n");
+    for (int stage = 0; stage < STAGE_MAX; stage++) {
+        client.printf("aida64_steady_allocations_total{stage=\"%s\"} %u\n",
+                      metricsStageName((PIPELINE_STAGE)stage), allocGetSteadyCount((PIPELINE_STAGE)stage));
+    }
+    client.printf("# HELP aida64_allocation_failures_total Failed heap allocations\n# TYPE aida64_allocation_failures_total counter\naida64_allocation_failures_total %u\n",
+                  allocGetFailed());
+#endif
+
+    client.printf("# HELP aida64_task_stack_free_bytes Stack high water mark per task\n# TYPE aida64_task_stack_free_bytes gauge\n");
+    for (int i = 0; i < taskCount; i++) {
+        client.printf("aida64_task_stack_free_bytes{task=\"%s\"} %u\n", tasks[i].name,
+                      (unsigned)uxTaskGetStackHighWaterMark(tasks[i].task));
+    }
+
+    client.printf("# HELP aida64_wifi_rssi_dbm WiFi signal strength\n# TYPE aida64_wifi_rssi_dbm gauge\naida64_wifi_rssi_dbm %d\n",
+                  WiFi.RSSI());
+    client.printf("# HELP aida64_wifi_connect_seconds Last time from start or disconnect to having an IP\n# TYPE aida64_wifi_connect_seconds gauge\n");
+    for (int path = 0; path < WIFI_PATH_MAX; path++) {
+        uint32_t count = 0;
+        uint32_t connect_ms = getWifiConnectMs((WIFI_CONNECT_PATH)path, &count);
+        if (count > 0) {
+            client.printf("aida64_wifi_connect_seconds{path=\"%s\"} %u.%03u\n", wifiPathNames[path], connect_ms / 1000, connect_ms % 1000);
+        }
+    }
+    client.printf("# HELP aida64_wifi_connects_total Successful WiFi connections\n# TYPE aida64_wifi_connects_total counter\n");
+    for (int path = 0; path < WIFI_PATH_MAX; path++) {
+        uint32_t count = 0;
+        getWifiConnectMs((WIFI_CONNECT_PATH)path, &count);
+        client.printf("aida64_wifi_connects_total{path=\"%s\"} %u\n", wifiPathNames[path], count);
+    }
+    client.printf("# HELP aida64_wifi_power_save WiFi power save mode (0 none, 1 modem sleep)\n# TYPE aida64_wifi_power_save gauge\naida64_wifi_power_save %d\n",
+                  (int)wifiPowerPolicy.getMode());
+    client.printf("# HELP aida64_sse_interarrival_seconds Gap between consecutive SSE frames per WiFi power save mode (follows the AIDA64 send period, not delivery latency)\n# TYPE aida64_sse_interarrival_seconds summary\n");
+    for (int mode = 0; mode < WIFI_PS_MODE_MAX; mode++) {
+        const char *name = WifiPowerPolicy::modeName((WIFI_PS_MODE)mode);
+        WIFI_PS_SUMMARY summary;
+        wifiPowerPolicy.getSummary((WIFI_PS_MODE)mode, summary);
+        if (summary.count > 0) {
+            const struct { const char *q; uint32_t ms; } quantiles[] = {
+                {"0.5", summary.p50_ms}, {"0.9", summary.p90_ms}, {"0.99", summary.p99_ms},
+            };
+            for (const auto &q : quantiles) {
+                client.printf("aida64_sse_interarrival_seconds{mode=\"%s\",quantile=\"%s\"} %u.%03u\n",
+                              name, q.q, q.ms / 1000, q.ms % 1000);
+            }
+        }
+        client.printf("aida64_sse_interarrival_seconds_sum{mode=\"%s\"} %u.%03u\n", name, summary.sum_ms / 1000, summary.sum_ms % 1000);
+        client.printf("aida64_sse_interarrival_seconds_count{mode=\"%s\"} %u\n", name, summary.count);
+    }
+    client.printf("# HELP aida64_sse_jitter_p90_seconds p90 of |inter-arrival gap - median gap| per WiFi power save mode: arrival jitter relative to the expected send period\n# TYPE aida64_sse_jitter_p90_seconds gauge\n");
+    for (int mode = 0; mode < WIFI_PS_MODE_MAX; mode++) {
+        WIFI_PS_SUMMARY summary;
+        wifiPowerPolicy.getSummary((WIFI_PS_MODE)mode, summary);
+        client.printf("aida64_sse_jitter_p90_seconds{mode=\"%s\"} %u.%03u\n", WifiPowerPolicy::modeName((WIFI_PS_MODE)mode),
+                      summary.jitter_p90_ms / 1000, summary.jitter_p90_ms % 1000);
+    }
+    client.printf("# HELP aida64_uptime_seconds Time since boot\n# TYPE aida64_uptime_seconds gauge\naida64_uptime_seconds %lu\n",
+                  millis() / 1000);
+    client.printf("# HELP aida64_render_quality Frame pacer quality level (0 = full)\n# TYPE aida64_render_quality gauge\naida64_render_quality %d\n",
+                  (int)display_enhanced.getRenderQuality());
+    client.printf("# HELP aida64_power_state Power state (0 active, 1 dimmed, 2 idle)\n# TYPE aida64_power_state gauge\naida64_power_state %d\n",
+                  (int)powerManager.getState());
+
+    client.printf("# HELP aida64_ntp_syncs_total Completed SNTP synchronisations\n# TYPE aida64_ntp_syncs_total counter\naida64_ntp_syncs_total %u\n",
+                  timeManager.getSyncCount());
+    if (timeManager.getSyncCount() > 0) {
+        int32_t offset_us = timeManager.getClockOffsetUs();
+        uint32_t offset_abs = offset_us < 0 ? -(uint32_t)offset_us : offset_us;
+        client.printf("# HELP aida64_ntp_sync_latency_seconds Time from SNTP request to the sync callback\n# TYPE aida64_ntp_sync_latency_seconds gauge\naida64_ntp_sync_latency_seconds %u.%06u\n",
+                      timeManager.getSyncLatencyUs() / 1000000, timeManager.getSyncLatencyUs() % 1000000);
+        client.printf("# HELP aida64_ntp_clock_offset_seconds Local clock error corrected by the last sync\n# TYPE aida64_ntp_clock_offset_seconds gauge\naida64_ntp_clock_offset_seconds %s%u.%06u\n",
+                      offset_us < 0 ? "-" : "", offset_abs / 1000000, offset_abs % 1000000);
+        client.printf("# HELP aida64_ntp_last_sync_age_seconds Time since the last sync\n# TYPE aida64_ntp_last_sync_age_seconds gauge\naida64_ntp_last_sync_age_seconds %lu\n",
+                      (millis() - timeManager.getLastSyncMs()) / 1000);
+    }
+}
+
+static void handleClient(WiFiClient &client)
+{
+    char request[64];
+    size_t len = 0;
+
+    client.setTimeout(1);
+    len = client.readBytesUntil('\n', request, sizeof(request) - 1);
+    request[len] = '\0';
+
+    // 丢弃剩余的请求头
+    while (client.available()) {
+        client.read();
+    }
+
+    if (strncmp(request, "GET /metrics", 12) == 0) {
+        client.print("HTTP/1.1 200 OK\r\n"
+                     "Content-Type: text/plain; version=0.0.4\r\n"
+                     "Connection: close\r\n\r\n");
+        writeMetrics(client);
+    } else if (strncmp(request, "GET /trace", 10) == 0) {
+        client.print("HTTP/1.1 200 OK\r\n"
+                     "Content-Type: application/octet-stream\r\n"
+                     "Connection: close\r\n\r\n");
+        traceDump(client);
+    } else {
+        client.print("HTTP/1.1 404 Not Found\r\nConnection: close\r\n\r\n");
+    }
+
+    client.stop();
+}
+
+void taskMetricsServer(void *param)
+{
+    WiFiServer server(METRICS_PORT);
+
+    metricsPrintLog("taskMetricsServer run!\r\n");
+
+    while (WiFi.status() != WL_CONNECTED) {
+        delay(1000);
+    }
+
+    server.begin();
+    metricsPrintLog("Serving /metrics on port %d\r\n", METRICS_PORT);
+
+    while (1) {
+        WiFiClient client = server.available();
+        if (client) {
+            handleClient(client);
+        } else {
+            delay(50);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,396 @@
+#ifndef ARDUINO
+
+/*
+ * env:native 入口
+ * 把录制的SSE数据 (curl -N http://<AIDA64>/sse > capture.txt) 按 解析 -> 绑定 -> LVGL渲染 的
+ * 同一管线回放到内存帧缓冲区, 结束后输出各阶段耗时, 可选保存最后一帧为PNG图像
+ *
+ * 用法: aida64_native [-b] [-g golden_dir [-u]] <capture|-> [layout.html] [out.png]
+ *   -b  基准模式: 每次更新输出分发、渲染、刷新耗时以及刷新的区域数和像素数, 结束时输出平均值和最大值
+ *   -g  与目录中的 frame_NNNN.png 逐帧比较, 有差异或缺少参考图像时退出码为1; 使用虚拟时钟,
+ *       每帧之间固定经过 NATIVE_FRAME_MS, 更新抽取和动画的结果与机器快慢无关
+ *   -u  用本次结果重写 -g 目录中的参考图像
+ *
+ * 以 env:native_alloc 构建时输出各阶段的堆分配次数, 预热后管线中有分配时退出码为1
+ * 单元测试在 test/ 下, 用 pio test -e native 运行; test_golden 以 -g 回放 test/replay 并与提交的参考图像比较
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "hal.h"
+#include "display.h"
+#include "aida64_parser.h"
+#include "metrics.h"
+#include "alloc_track.h"
+#include "native_replay.h"
+#include "png_image.h"
+
+// 每帧数据之后驱动LVGL的时间 (毫秒), 覆盖帧节拍器的一个帧周期
+#ifndef NATIVE_FRAME_MS
+#define NATIVE_FRAME_MS (LV_DISP_DEF_REFR_PERIOD * 2)
+#endif
+// 等待进度条动画结束的最长时间, 保证参考图像与渲染时序无关
+#ifndef NATIVE_SETTLE_MS
+#define NATIVE_SETTLE_MS 2000
+#endif
+
+int screen_dir = SCREEN_DIR_HORIZONTAL;
+
+static AIDA64_STREAM stream;
+static std::vector<AIDA64_DATA> frame;
+
+static bool benchMode = false;
+static const char *goldenDir = NULL;
+static bool updateGolden = false;
+static uint32_t goldenFailures = 0;
+
+// 基准模式的汇总, 便于比较修改前后的结果
+enum BENCH_COLUMN {
+    BENCH_DISPATCH,
+    BENCH_RENDER,
+    BENCH_FLUSH,
+    BENCH_AREAS,
+    BENCH_PIXELS,
+    BENCH_COLUMN_MAX,
+};
+static const char *benchColumns[BENCH_COLUMN_MAX] = {"dispatch_us", "render_us", "flush_us", "areas", "pixels"};
+static uint64_t benchSum[BENCH_COLUMN_MAX];
+static uint32_t benchMax[BENCH_COLUMN_MAX];
+static uint32_t benchUpdates = 0;
+
+static void runDisplay(uint32_t duration_ms)
+{
+    uint32_t start = halMillis();
+
+    while (halMillis() - start < duration_ms ||
+           (goldenDir && (lv_anim_count_running() > 0 || display_enhanced.barsAnimating()) &&
+            halMillis() - start < NATIVE_SETTLE_MS)) {
+        uint32_t wait = display_enhanced.tick();
+        if (goldenDir) {
+            halAdvanceMillis(wait > 0 ? wait : 1);
+        } else {
+            usleep(wait * 1000);
+        }
+    }
+}
+
+static bool loadLayout(const char *path)
+{
+    std::vector<AIDA64_LAYOUT_ITEM> layout;
+    std::vector<char> html;
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+
+    char chunk[1024];
+    size_t len;
+    while ((len = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        html.insert(html.end(), chunk, chunk + len);
+    }
+    fclose(file);
+    html.push_back('\0');
+
+    parseAida64Layout(html.data(), layout);
+    if (layout.empty()) {
+        fprintf(stderr, "%s: no LCD items found\n", path);
+        return false;
+    }
+    publishAida64Layout(layout);
+    return true;
+}
+
+// 帧缓冲区为面板字节序 (大端RGB565), 转换为8位RGB
+static void framebufferRgb(std::vector<uint8_t> &rgb, uint32_t *width, uint32_t *height)
+{
+    const uint8_t *pixels = (const uint8_t *)halFramebuffer(width, height);
+
+    rgb.resize(*width * *height * 3);
+    for (uint32_t i = 0; i < *width * *height; i++) {
+        uint16_t color = (pixels[i * 2] << 8) | pixels[i * 2 + 1];
+        rgb[i * 3] = ((color >> 11) & 0x1f) * 255 / 31;
+        rgb[i * 3 + 1] = ((color >> 5) & 0x3f) * 255 / 63;
+        rgb[i * 3 + 2] = (color & 0x1f) * 255 / 31;
+    }
+}
+
+static bool writeFrame(const char *path)
+{
+    std::vector<uint8_t> rgb;
+    uint32_t width, height;
+
+    framebufferRgb(rgb, &width, &height);
+    return pngWrite(path, rgb.data(), width, height);
+}
+
+// 与参考图像比较, 返回不同的像素数, 没有参考图像时返回-1
+static int32_t compareGolden(const char *path)
+{
+    std::vector<uint8_t> actual, golden;
+    uint32_t width, height, golden_width, golden_height;
+    int32_t diff = 0;
+
+    if (!pngRead(path, golden, &golden_width, &golden_height)) {
+        return -1;
+    }
+
+    framebufferRgb(actual, &width, &height);
+    if (width != golden_width || height != golden_height) {
+        return width * height;
+    }
+
+    for (uint32_t i = 0; i < width * height; i++) {
+        if (memcmp(&actual[i * 3], &golden[i * 3], 3) != 0) {
+            diff++;
+        }
+    }
+    return diff;
+}
+
+static void checkGolden(uint32_t index)
+{
+    char path[256];
+
+    snprintf(path, sizeof(path), "%s/frame_%04u.png", goldenDir, index);
+    if (updateGolden) {
+        writeFrame(path);
+        return;
+    }
+
+    int32_t diff = compareGolden(path);
+    if (diff < 0) {
+        printf("golden %s missing\n", path);
+        goldenFailures++;
+    } else if (diff > 0) {
+        // 保存实际结果, 便于和参考图像对比查看
+        char actual[272];
+        snprintf(actual, sizeof(actual), "%s.actual.png", path);
+        writeFrame(actual);
+        printf("golden %s: %d pixels differ, wrote %s\n", path, diff, actual);
+        goldenFailures++;
+    }
+}
+
+// 一个窗口内的总耗时
+static uint32_t stageTotal(PIPELINE_STAGE stage)
+{
+    STAGE_WINDOW window;
+
+    metricsTakeStageWindow(stage, window);
+    return window.avg_us * window.count;
+}
+
+static void printStages()
+{
+    printf("%-8s %8s %8s %8s %8s\n", "stage", "count", "min_us", "avg_us", "max_us");
+    for (int stage = 0; stage < STAGE_MAX; stage++) {
+        STAGE_WINDOW window;
+        metricsTakeStageWindow((PIPELINE_STAGE)stage, window);
+        printf("%-8s %8u %8u %8u %8u\n", metricsStageName((PIPELINE_STAGE)stage),
+               window.count, window.min_us, window.avg_us, window.max_us);
+    }
+}
+
+static void printBenchSummary()
+{
+    printf("%-12s %10s %10s\n", "per update", "avg", "max");
+    for (int i = 0; i < BENCH_COLUMN_MAX; i++) {
+        printf("%-12s %10u %10u\n", benchColumns[i],
+               benchUpdates ? (unsigned)(benchSum[i] / benchUpdates) : 0, benchMax[i]);
+    }
+}
+
+static void updateFrame(uint32_t index, uint32_t arrivalUs)
+{
+    uint32_t areas = metricsGet(METRIC_FLUSH_AREAS);
+    uint32_t pixels = metricsGet(METRIC_FLUSH_PIXELS);
+
+    display_enhanced.displayAida64Data(frame, arrivalUs);
+    runDisplay(NATIVE_FRAME_MS);
+
+    if (benchMode) {
+        // 基准模式下逐帧清空阶段窗口, 每行只包含本次更新
+        uint32_t values[BENCH_COLUMN_MAX] = {
+            stageTotal(STAGE_DISPATCH),
+            stageTotal(STAGE_RENDER),
+            stageTotal(STAGE_FLUSH),
+            metricsGet(METRIC_FLUSH_AREAS) - areas,
+            metricsGet(METRIC_FLUSH_PIXELS) - pixels,
+        };
+        printf("%6u %10u %10u %10u %8u %10u\n", index, values[BENCH_DISPATCH], values[BENCH_RENDER],
+               values[BENCH_FLUSH], values[BENCH_AREAS], values[BENCH_PIXELS]);
+
+        for (int i = 0; i < BENCH_COLUMN_MAX; i++) {
+            benchSum[i] += values[i];
+            if (values[i] > benchMax[i]) {
+                benchMax[i] = values[i];
+            }
+        }
+        benchUpdates++;
+    }
+
+    if (goldenDir) {
+        checkGolden(index);
+    }
+}
+
+int nativeReplay(int argc, char *argv[])
+{
+    uint32_t frames = 0;
+    int fd;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "bg:u")) != -1) {
+        switch (opt) {
+            case 'b': benchMode = true; break;
+            case 'g': goldenDir = optarg; break;
+            case 'u': updateGolden = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-b] [-g golden_dir [-u]] <capture|-> [layout.html] [out.png]\n", argv[0]);
+                return 2;
+        }
+    }
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 1) {
+        fprintf(stderr, "missing capture file\n");
+        return 2;
+    }
+
+    fd = strcmp(argv[0], "-") == 0 ? STDIN_FILENO : open(argv[0], O_RDONLY);
+    if (fd < 0) {
+        perror(argv[0]);
+        return 1;
+    }
+
+    if (goldenDir) {
+        halUseVirtualClock();
+    }
+    logBegin();
+    allocTrackBegin();
+    display_enhanced.begin(screen_dir);
+    if (argc >= 2 && !loadLayout(argv[1])) {
+        return 1;
+    }
+    aida64StreamReset(stream);
+
+    if (benchMode) {
+        // 启动时的首帧不计入
+        runDisplay(NATIVE_FRAME_MS);
+        for (int stage = 0; stage < STAGE_MAX; stage++) {
+            stageTotal((PIPELINE_STAGE)stage);
+        }
+        printf("%6s %10s %10s %10s %8s %10s\n", "frame", "dispatch_us", "render_us", "flush_us", "areas", "pixels");
+    }
+
+    while (1) {
+        size_t space;
+        char *writePtr = aida64StreamWritePtr(stream, &space);
+        uint32_t recvStartUs = halMicros();
+        int len;
+        {
+            ALLOC_STAGE(STAGE_RECV);
+            len = halRecv(fd, writePtr, space);
+        }
+        if (len <= 0) {
+            break;
+        }
+
+        uint32_t arrivalUs = halMicros();
+        metricsStage(STAGE_RECV, arrivalUs - recvStartUs);
+        aida64StreamCommit(stream, len);
+
+        char *event;
+        uint32_t assemblyStartUs = arrivalUs;
+        while (1) {
+            {
+                ALLOC_STAGE(STAGE_ASSEMBLY);
+                event = aida64StreamNextEvent(stream);
+            }
+            if (event == NULL) {
+                break;
+            }
+            uint32_t parseStartUs = halMicros();
+            metricsStage(STAGE_ASSEMBLY, parseStartUs - assemblyStartUs);
+
+            parseAida64Data(event, frame);
+            assemblyStartUs = halMicros();
+            metricsStage(STAGE_PARSE, assemblyStartUs - parseStartUs);
+
+            if (!frame.empty()) {
+                updateFrame(frames, arrivalUs);
+                frames++;
+            }
+        }
+    }
+
+    if (fd != STDIN_FILENO) {
+        close(fd);
+    }
+
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    printf("%u frames\n", frames);
+    printStages();
+    if (benchMode) {
+        printBenchSummary();
+    }
+    // 更新等级抽取节省的解析和控件更新
+    uint32_t applied = metricsGet(METRIC_BINDINGS_APPLIED);
+    uint32_t decimated = metricsGet(METRIC_BINDINGS_DECIMATED);
+    printf("bindings: %u applied, %u decimated (%u%%), %u widget updates\n", applied, decimated,
+           applied + decimated ? decimated * 100 / (applied + decimated) : 0, metricsGet(METRIC_WIDGET_UPDATES));
+    printf("lvgl pool: %u bytes free, largest block %u, %u%% fragmented\n",
+           (unsigned)mon.free_size, (unsigned)mon.free_biggest_size, mon.frag_pct);
+
+#if ALLOC_TRACK
+    printf("%-8s %8s %8s %8s\n", "stage", "allocs", "lvgl", "steady");
+    for (int stage = 0; stage < STAGE_MAX; stage++) {
+        printf("%-8s %8u %8u %8u%s\n", metricsStageName((PIPELINE_STAGE)stage), allocGetCount((PIPELINE_STAGE)stage),
+               allocGetLvglCount((PIPELINE_STAGE)stage), allocGetSteadyCount((PIPELINE_STAGE)stage),
+               (ALLOC_STRICT_STAGES & (1u << stage)) ? "" : " (not enforced)");
+    }
+    printf("steady-state allocations: %u%s\n", allocGetViolations(),
+           allocIsSteady() ? "" : " (warm-up not finished)");
+#endif
+
+    if (argc >= 3 && !writeFrame(argv[2])) {
+        return 1;
+    }
+    if (goldenDir && !updateGolden) {
+        // 回放的帧数少于参考图像时, 多出的参考图像同样算作差异
+        char path[256];
+        snprintf(path, sizeof(path), "%s/frame_%04u.png", goldenDir, frames);
+        if (frames == 0 || access(path, F_OK) == 0) {
+            printf("golden: replay produced %u frames, references differ\n", frames);
+            goldenFailures++;
+        }
+        printf("golden: %u of %u frames differ\n", goldenFailures, frames);
+        if (goldenFailures) {
+            return 1;
+        }
+    }
+#if ALLOC_TRACK
+    if (allocGetViolations() > 0) {
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+// pio test -e native 链接同样的源文件, 入口由测试提供
+#ifndef PIO_UNIT_TESTING
+int main(int argc, char *argv[])
+{
+    return nativeReplay(argc, argv);
+}
+#endif
+
+#endif
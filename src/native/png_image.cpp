@@ -0,0 +1,204 @@
+#ifndef ARDUINO
+
+#include "png_image.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#define PNG_BYTES_PER_PIXEL 3
+// 参考图像为屏幕尺寸, 更大的文件视为损坏
+#define PNG_MAX_DIMENSION 4096
+
+static const uint8_t pngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+static void putBe32(uint8_t *p, uint32_t value)
+{
+    p[0] = value >> 24;
+    p[1] = value >> 16;
+    p[2] = value >> 8;
+    p[3] = value;
+}
+
+static uint32_t getBe32(const uint8_t *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static bool writeChunk(FILE *file, const char *type, const uint8_t *data, uint32_t len)
+{
+    uint8_t header[8];
+    uint8_t trailer[4];
+
+    putBe32(header, len);
+    memcpy(header + 4, type, 4);
+    // CRC覆盖类型和数据, 不含长度
+    uLong crc = crc32(0, header + 4, 4);
+    if (len > 0) {
+        // zlib的crc32在data为NULL时返回初始值, 空数据块 (IEND) 不能传入
+        crc = crc32(crc, data, len);
+    }
+    putBe32(trailer, crc);
+
+    return fwrite(header, 1, sizeof(header), file) == sizeof(header) &&
+           fwrite(data, 1, len, file) == len &&
+           fwrite(trailer, 1, sizeof(trailer), file) == sizeof(trailer);
+}
+
+bool pngWrite(const char *path, const uint8_t *rgb, uint32_t width, uint32_t height)
+{
+    size_t stride = (size_t)width * PNG_BYTES_PER_PIXEL;
+    std::vector<uint8_t> raw((stride + 1) * height);
+
+    // 每行前加过滤类型0 (不过滤), 界面大部分是纯色, 直接交给deflate效果已经足够
+    for (uint32_t y = 0; y < height; y++) {
+        raw[y * (stride + 1)] = 0;
+        memcpy(&raw[y * (stride + 1) + 1], rgb + y * stride, stride);
+    }
+
+    uLongf packed_len = compressBound(raw.size());
+    std::vector<uint8_t> packed(packed_len);
+    if (compress2(packed.data(), &packed_len, raw.data(), raw.size(), Z_BEST_COMPRESSION) != Z_OK) {
+        fprintf(stderr, "%s: compression failed\n", path);
+        return false;
+    }
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        perror(path);
+        return false;
+    }
+
+    uint8_t ihdr[13];
+    putBe32(ihdr, width);
+    putBe32(ihdr + 4, height);
+    ihdr[8] = 8;        // 位深
+    ihdr[9] = 2;        // RGB
+    ihdr[10] = 0;       // deflate
+    ihdr[11] = 0;       // 自适应过滤
+    ihdr[12] = 0;       // 不隔行
+
+    bool ok = fwrite(pngSignature, 1, sizeof(pngSignature), file) == sizeof(pngSignature) &&
+              writeChunk(file, "IHDR", ihdr, sizeof(ihdr)) &&
+              writeChunk(file, "IDAT", packed.data(), packed_len) &&
+              writeChunk(file, "IEND", NULL, 0);
+    ok = fclose(file) == 0 && ok;
+    if (!ok) {
+        perror(path);
+    }
+    return ok;
+}
+
+static uint8_t paeth(uint8_t a, uint8_t b, uint8_t c)
+{
+    int p = a + b - c;
+    int pa = abs(p - a);
+    int pb = abs(p - b);
+    int pc = abs(p - c);
+
+    if (pa <= pb && pa <= pc) {
+        return a;
+    }
+    return pb <= pc ? b : c;
+}
+
+// 按行还原过滤, prev为上一行 (第一行为全0)
+static bool unfilterRow(uint8_t filter, uint8_t *row, const uint8_t *prev, size_t stride)
+{
+    for (size_t i = 0; i < stride; i++) {
+        uint8_t left = i >= PNG_BYTES_PER_PIXEL ? row[i - PNG_BYTES_PER_PIXEL] : 0;
+        uint8_t up = prev[i];
+        uint8_t up_left = i >= PNG_BYTES_PER_PIXEL ? prev[i - PNG_BYTES_PER_PIXEL] : 0;
+
+        switch (filter) {
+            case 0: break;
+            case 1: row[i] += left; break;
+            case 2: row[i] += up; break;
+            case 3: row[i] += (left + up) / 2; break;
+            case 4: row[i] += paeth(left, up, up_left); break;
+            default: return false;
+        }
+    }
+    return true;
+}
+
+bool pngRead(const char *path, std::vector<uint8_t> &rgb, uint32_t *width, uint32_t *height)
+{
+    std::vector<uint8_t> data;
+    FILE *file = fopen(path, "rb");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    uint8_t chunk[4096];
+    size_t len;
+    while ((len = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.insert(data.end(), chunk, chunk + len);
+    }
+    fclose(file);
+
+    if (data.size() < sizeof(pngSignature) || memcmp(data.data(), pngSignature, sizeof(pngSignature)) != 0) {
+        fprintf(stderr, "%s: not a PNG file\n", path);
+        return false;
+    }
+
+    // 依次读取数据块, 只处理IHDR/IDAT/IEND, 其余辅助块忽略
+    std::vector<uint8_t> packed;
+    uint32_t w = 0, h = 0;
+    size_t pos = sizeof(pngSignature);
+    bool end = false;
+    while (!end && pos + 12 <= data.size()) {
+        uint32_t chunk_len = getBe32(&data[pos]);
+        const uint8_t *type = &data[pos + 4];
+        const uint8_t *body = &data[pos + 8];
+        if (chunk_len > data.size() - pos - 12) {
+            break;
+        }
+
+        if (memcmp(type, "IHDR", 4) == 0 && chunk_len == 13) {
+            w = getBe32(body);
+            h = getBe32(body + 4);
+            if (body[8] != 8 || body[9] != 2 || body[12] != 0) {
+                fprintf(stderr, "%s: only 8-bit RGB non-interlaced PNG is supported\n", path);
+                return false;
+            }
+        } else if (memcmp(type, "IDAT", 4) == 0) {
+            packed.insert(packed.end(), body, body + chunk_len);
+        } else if (memcmp(type, "IEND", 4) == 0) {
+            end = true;
+        }
+        pos += 12 + chunk_len;
+    }
+
+    if (!end || w == 0 || h == 0 || w > PNG_MAX_DIMENSION || h > PNG_MAX_DIMENSION) {
+        fprintf(stderr, "%s: truncated or invalid PNG\n", path);
+        return false;
+    }
+
+    size_t stride = (size_t)w * PNG_BYTES_PER_PIXEL;
+    std::vector<uint8_t> raw((stride + 1) * h);
+    uLongf raw_len = raw.size();
+    if (uncompress(raw.data(), &raw_len, packed.data(), packed.size()) != Z_OK || raw_len != raw.size()) {
+        fprintf(stderr, "%s: corrupt image data\n", path);
+        return false;
+    }
+
+    rgb.resize(stride * h);
+    std::vector<uint8_t> zero(stride, 0);
+    for (uint32_t y = 0; y < h; y++) {
+        uint8_t *row = &raw[y * (stride + 1)];
+        const uint8_t *prev = y > 0 ? &raw[(y - 1) * (stride + 1) + 1] : zero.data();
+        if (!unfilterRow(row[0], row + 1, prev, stride)) {
+            fprintf(stderr, "%s: unknown row filter %u\n", path, row[0]);
+            return false;
+        }
+        memcpy(&rgb[y * stride], row + 1, stride);
+    }
+
+    *width = w;
+    *height = h;
+    return true;
+}
+
+#endif
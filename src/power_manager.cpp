@@ -0,0 +1,128 @@
+#include "power_manager.h"
+#include "hal.h"
+#include "display.h"
+
+// 各状态累计时间的打印间隔
+#define POWER_REPORT_INTERVAL (10 * 60 * 1000)
+// 空闲时loop()的最长休眠时间, 仍足够及时响应触摸
+#define POWER_IDLE_LOOP_MS 100
+
+static const char* stateNames[POWER_STATE_MAX] = {
+    "active",
+    "dimmed",
+    "idle",
+};
+
+PowerManager::PowerManager() {
+    state = POWER_ACTIVE;
+    sleep_requested = false;
+    last_activity = 0;
+    state_enter = 0;
+    last_report = 0;
+    for (int i = 0; i < POWER_STATE_MAX; i++) {
+        state_time[i] = 0;
+    }
+}
+
+void PowerManager::begin() {
+    last_activity = halMillis();
+    state_enter = last_activity;
+    last_report = last_activity;
+    state = POWER_ACTIVE;
+
+    display_enhanced.setBacklight(BACKLIGHT_FULL_LEVEL);
+    powerPrintLog("Power manager started\r\n");
+}
+
+void PowerManager::onDataArrived() {
+    last_activity = halMillis();
+
+    // 数据恢复时立即唤醒, 本次数据在同一帧内显示
+    if (state != POWER_ACTIVE && !sleep_requested) {
+        enterState(POWER_ACTIVE);
+    }
+}
+
+void PowerManager::service() {
+    unsigned long now = halMillis();
+    unsigned long since = now - last_activity;
+    POWER_STATE target = POWER_ACTIVE;
+
+    // 触摸也算作活动, 用于在空闲时手动唤醒屏幕
+    uint32_t inactive = lv_disp_get_inactive_time(NULL);
+    if (inactive < since) {
+        last_activity = now - inactive;
+        since = inactive;
+    }
+
+    if (sleep_requested || since >= POWER_IDLE_TIMEOUT) {
+        target = POWER_IDLE;
+    } else if (since >= POWER_DIM_TIMEOUT) {
+        target = POWER_DIMMED;
+    }
+
+    if (target != state) {
+        enterState(target);
+    }
+
+    if (now - last_report >= POWER_REPORT_INTERVAL) {
+        reportStateTimes();
+        last_report = now;
+    }
+}
+
+uint32_t PowerManager::adjustWait(uint32_t wait) const {
+    if (state == POWER_IDLE && wait < POWER_IDLE_LOOP_MS) {
+        return POWER_IDLE_LOOP_MS;
+    }
+    return wait;
+}
+
+unsigned long PowerManager::getStateTime(POWER_STATE s) const {
+    unsigned long total = state_time[s];
+    if (s == state) {
+        total += halMillis() - state_enter;
+    }
+    return total;
+}
+
+void PowerManager::enterState(POWER_STATE next) {
+    unsigned long now = halMillis();
+
+    state_time[state] += now - state_enter;
+    state_enter = now;
+
+    switch (next) {
+        case POWER_ACTIVE:
+            halSetCpuMhz(CPU_ACTIVE_MHZ);
+            display_enhanced.setRenderingPaused(false);
+            display_enhanced.setBacklight(BACKLIGHT_FULL_LEVEL);
+            break;
+        case POWER_DIMMED:
+            halSetCpuMhz(CPU_ACTIVE_MHZ);
+            display_enhanced.setRenderingPaused(false);
+            display_enhanced.setBacklight(BACKLIGHT_DIM_LEVEL);
+            break;
+        case POWER_IDLE:
+            display_enhanced.setBacklight(0);
+            display_enhanced.setRenderingPaused(true);
+            halSetCpuMhz(CPU_IDLE_MHZ);
+            break;
+        default:
+            break;
+    }
+
+    powerPrintLog("%s -> %s (no data for %lus)\r\n", stateNames[state], stateNames[next],
+                  (now - last_activity) / 1000);
+    state = next;
+}
+
+void PowerManager::reportStateTimes() {
+    powerPrintLog("time in state: active=%lus dimmed=%lus idle=%lus\r\n",
+                  getStateTime(POWER_ACTIVE) / 1000,
+                  getStateTime(POWER_DIMMED) / 1000,
+                  getStateTime(POWER_IDLE) / 1000);
+}
+
+// 全局实例
+PowerManager powerManager;
@@ -1,55 +1,100 @@
 #include "time_manager.h"
 #include "public.h"
+#include <esp_sntp.h>
+#include <atomic>
+
+// 等待SNTP回调的超时, 超时后重新发起请求
+#ifndef NTP_SYNC_TIMEOUT
+#define NTP_SYNC_TIMEOUT (15 * 1000)
+#endif
+
+// SNTP回调在lwIP任务中执行, 只记录结果, 由loop()处理
+static std::atomic<bool> syncPending(false);
+static struct timeval syncTv;
+static int64_t syncUs;
 
 TimeManager::TimeManager() {
     last_ntp_sync = 0;
-    last_time_update = 0;
     time_synced = false;
+    
+    state = TIME_SYNC_IDLE;
+    request_ms = 0;
+    request_us = 0;
+    retries = 0;
+    
+    memset(&last_sync_tv, 0, sizeof(last_sync_tv));
+    last_sync_us = 0;
+    sync_latency_us = 0;
+    clock_offset_us = 0;
+    sync_count = 0;
+}
+
+void TimeManager::onTimeSync(struct timeval *tv) {
+    syncUs = esp_timer_get_time();
+    syncTv = *tv;
+    syncPending.store(true, std::memory_order_release);
 }
 
 void TimeManager::initNTP() {
     UARTPrintf("[TIME] Initializing NTP time synchronization...\r\n");
     
-    // 配置时区
+    // 配置时区并启动SNTP, 不等待结果
+    sntp_set_time_sync_notification_cb(onTimeSync);
+    sntp_set_sync_interval(NTP_UPDATE_INTERVAL);
+    
+    request_ms = millis();
+    request_us = micros();
+    retries = 0;
+    state = TIME_SYNC_WAITING;
     configTime(TIMEZONE_OFFSET_SECONDS, 0, NTP_SERVER_1, NTP_SERVER_2, NTP_SERVER_3);
     
-    // 等待时间同步
     UARTPrintf("[TIME] Waiting for NTP time sync...\r\n");
-    time_t now = 0;
-    struct tm timeinfo = { 0 };
-    int retry = 0;
-    const int retry_count = 15;
-    
-    while (!getLocalTime(&timeinfo) && retry < retry_count) {
-        delay(1000);
-        retry++;
-        UARTPrintf("[TIME] Waiting for NTP sync... (%d/%d)\r\n", retry, retry_count);
+}
+
+void TimeManager::requestSync() {
+    request_ms = millis();
+    request_us = micros();
+    state = TIME_SYNC_WAITING;
+    sntp_restart();
+}
+
+void TimeManager::handleSync(const struct timeval &tv, int64_t sync_us) {
+    // 按上一次同步的时间加上本地经过的时间推算当前时间, 与NTP结果之差即本地时钟的偏差
+    if (sync_count > 0) {
+        int64_t predicted = (int64_t)last_sync_tv.tv_sec * 1000000 + last_sync_tv.tv_usec + (sync_us - last_sync_us);
+        int64_t actual = (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+        int64_t offset = actual - predicted;
+        if (offset > INT32_MAX) offset = INT32_MAX;
+        if (offset < INT32_MIN) offset = INT32_MIN;
+        clock_offset_us = (int32_t)offset;
     }
     
-    if (retry < retry_count) {
-        time_synced = true;
-        last_ntp_sync = millis();
-        UARTPrintf("[TIME] NTP time synchronized successfully!\r\n");
-        UARTPrintf("[TIME] Current time: %s\r\n", getCurrentDateTimeString().c_str());
-    } else {
-        time_synced = false;
-        UARTPrintf("[TIME] Failed to synchronize NTP time\r\n");
+    // SNTP自行发起的周期同步没有对应的请求, 不计延迟
+    if (state == TIME_SYNC_WAITING) {
+        sync_latency_us = (uint32_t)sync_us - request_us;
     }
+    
+    last_sync_tv = tv;
+    last_sync_us = sync_us;
+    sync_count++;
+    retries = 0;
+    
+    time_synced = true;
+    last_ntp_sync = millis();
+    state = TIME_SYNC_SYNCED;
+    
+    UARTPrintf("[TIME] NTP time synchronized: %s (latency %ums, offset %dms)\r\n",
+               getCurrentDateTimeString().c_str(), sync_latency_us / 1000, clock_offset_us / 1000);
 }
 
-String TimeManager::getCurrentTimeString() {
+int32_t TimeManager::getSecondsOfDay() const {
     if (!time_synced) {
-        return "--:--:--";
+        return -1;
     }
     
-    struct tm timeinfo;
-    if (!getLocalTime(&timeinfo)) {
-        return "--:--:--";
-    }
-    
-    char timeString[16];
-    strftime(timeString, sizeof(timeString), "%H:%M:%S", &timeinfo);
-    return String(timeString);
+    int64_t now_us = (int64_t)last_sync_tv.tv_sec * 1000000 + last_sync_tv.tv_usec + (esp_timer_get_time() - last_sync_us);
+    int64_t local_sec = now_us / 1000000 + TIMEZONE_OFFSET_SECONDS;
+    return (int32_t)(local_sec % 86400);
 }
 
 String TimeManager::getCurrentDateTimeString() {
@@ -58,7 +103,7 @@ String TimeManager::getCurrentDateTimeString() {
     }
     
     struct tm timeinfo;
-    if (!getLocalTime(&timeinfo)) {
+    if (!getLocalTime(&timeinfo, 0)) {
         return "----/--/-- --:--:--";
     }
     
@@ -70,41 +115,38 @@ String TimeManager::getCurrentDateTimeString() {
 void TimeManager::checkAndSyncTime() {
     unsigned long current_millis = millis();
     
-    // 检查是否需要重新同步时间（每小时一次）
-    if (time_synced && (current_millis - last_ntp_sync >= NTP_UPDATE_INTERVAL)) {
-        UARTPrintf("[TIME] Performing periodic NTP resync...\r\n");
-        forceSyncTime();
+    if (syncPending.load(std::memory_order_acquire)) {
+        struct timeval tv = syncTv;
+        int64_t sync_us = syncUs;
+        syncPending.store(false, std::memory_order_relaxed);
+        handleSync(tv, sync_us);
     }
     
-    // 处理millis()溢出情况（约49天后会发生）
-    if (current_millis < last_ntp_sync) {
-        last_ntp_sync = current_millis;
+    switch (state) {
+        case TIME_SYNC_IDLE:
+            break;
+            
+        case TIME_SYNC_WAITING:
+            if (current_millis - request_ms >= NTP_SYNC_TIMEOUT) {
+                retries++;
+                UARTPrintf("[TIME] No NTP response after %ds, retrying (%d)\r\n", NTP_SYNC_TIMEOUT / 1000, retries);
+                requestSync();
+            }
+            break;
+            
+        case TIME_SYNC_SYNCED:
+            // SNTP按周期自行同步; 长时间没有回调时主动重新请求
+            if (current_millis - last_ntp_sync >= NTP_UPDATE_INTERVAL + NTP_SYNC_TIMEOUT) {
+                UARTPrintf("[TIME] Periodic NTP sync overdue, requesting resync...\r\n");
+                requestSync();
+            }
+            break;
     }
 }
 
 void TimeManager::forceSyncTime() {
     UARTPrintf("[TIME] Force syncing time with NTP servers...\r\n");
-    
-    // 重新配置时间
-    configTime(TIMEZONE_OFFSET_SECONDS, 0, NTP_SERVER_1, NTP_SERVER_2, NTP_SERVER_3);
-    
-    // 等待同步完成
-    struct tm timeinfo;
-    int retry = 0;
-    const int retry_count = 10;
-    
-    while (!getLocalTime(&timeinfo) && retry < retry_count) {
-        delay(500);
-        retry++;
-    }
-    
-    if (retry < retry_count) {
-        time_synced = true;
-        last_ntp_sync = millis();
-        UARTPrintf("[TIME] Time resync successful: %s\r\n", getCurrentDateTimeString().c_str());
-    } else {
-        UARTPrintf("[TIME] Time resync failed\r\n");
-    }
+    requestSync();
 }
 
 // 全局实例
@@ -0,0 +1,147 @@
+#include "trace.h"
+#include <atomic>
+
+static_assert((TRACE_EVENTS & (TRACE_EVENTS - 1)) == 0, "TRACE_EVENTS must be a power of 2");
+static_assert(sizeof(TRACE_EVENT) == 12, "TRACE_EVENT layout is part of the dump format");
+
+#define TRACE_MAX_TASKS 8
+#define TRACE_HEX_LINE 32
+
+static const char *traceNames[TRACE_ID_MAX] = {
+    "loop",
+    "http_recv",
+    "http_frame",
+    "parse",
+    "dispatch",
+    "refresh",
+    "flush",
+};
+
+// 关闭跟踪时不占用内存, head保持为0, 导出为空
+static TRACE_EVENT traceRing[TRACE_ENABLE ? TRACE_EVENTS : 1];
+static std::atomic<uint32_t> traceHead(0);
+static std::atomic<bool> tracePaused(false);
+
+#if TRACE_ENABLE
+void traceEvent(TRACE_ID id, TRACE_TYPE type)
+{
+    if (tracePaused.load(std::memory_order_relaxed)) {
+        return;
+    }
+
+    // 满后直接覆盖最旧的事件, 保留最近一段时间线
+    uint32_t index = traceHead.fetch_add(1, std::memory_order_relaxed);
+    TRACE_EVENT &event = traceRing[index & (TRACE_EVENTS - 1)];
+
+    event.time_us = micros();
+    event.task = (uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle();
+    event.id = id;
+    event.type = type;
+    event.core = xPortGetCoreID();
+    event.reserved = 0;
+}
+#endif
+
+// 串口导出用: 把二进制流编码为 "TRACE:<hex>" 行, 每行一次写入, 不会与日志行交错
+class TraceHexPrint : public Print {
+public:
+    TraceHexPrint() : len(0) {}
+
+    size_t write(uint8_t c) override {
+        data[len++] = c;
+        if (len == TRACE_HEX_LINE) flushLine();
+        return 1;
+    }
+
+    size_t write(const uint8_t *buffer, size_t size) override {
+        for (size_t i = 0; i < size; i++) write(buffer[i]);
+        return size;
+    }
+
+    // 输出最后一个不满的行
+    void finish() { flushLine(); }
+
+private:
+    uint8_t data[TRACE_HEX_LINE];
+    size_t len;
+
+    void flushLine() {
+        static const char hex[] = "0123456789abcdef";
+        char line[6 + TRACE_HEX_LINE * 2 + 2];
+        size_t out = 0;
+
+        if (len == 0) return;
+
+        memcpy(line, "TRACE:", 6);
+        out = 6;
+        for (size_t i = 0; i < len; i++) {
+            line[out++] = hex[data[i] >> 4];
+            line[out++] = hex[data[i] & 0x0f];
+        }
+        line[out++] = '\r';
+        line[out++] = '\n';
+        Serial.write((const uint8_t *)line, out);
+        len = 0;
+    }
+};
+
+void traceDump(Print &out)
+{
+    TRACE_HEADER header;
+    TRACE_TASK tasks[TRACE_MAX_TASKS];
+    uint16_t taskCount = 0;
+    char name[TRACE_NAME_SIZE];
+
+    tracePaused.store(true, std::memory_order_relaxed);
+
+    uint32_t head = traceHead.load(std::memory_order_relaxed);
+    uint32_t count = head < TRACE_EVENTS ? head : TRACE_EVENTS;
+    uint32_t start = head - count;
+
+    // 收集出现过的任务, 导出任务名供主机端标注线程
+    memset(tasks, 0, sizeof(tasks));
+    for (uint32_t i = start; i != head; i++) {
+        uint32_t task = traceRing[i & (TRACE_EVENTS - 1)].task;
+        uint16_t t = 0;
+
+        while (t < taskCount && tasks[t].task != task) t++;
+        if (t == taskCount && taskCount < TRACE_MAX_TASKS) {
+            tasks[t].task = task;
+            strncpy(tasks[t].name, pcTaskGetTaskName((TaskHandle_t)(uintptr_t)task), TRACE_NAME_SIZE - 1);
+            taskCount++;
+        }
+    }
+
+    header.magic = TRACE_MAGIC;
+    header.version = TRACE_VERSION;
+    header.event_size = sizeof(TRACE_EVENT);
+    header.count = count;
+    header.task_count = taskCount;
+    header.name_count = TRACE_ID_MAX;
+    out.write((const uint8_t *)&header, sizeof(header));
+    out.write((const uint8_t *)tasks, taskCount * sizeof(TRACE_TASK));
+
+    for (int i = 0; i < TRACE_ID_MAX; i++) {
+        memset(name, 0, sizeof(name));
+        strncpy(name, traceNames[i], sizeof(name) - 1);
+        out.write((const uint8_t *)name, sizeof(name));
+    }
+
+    for (uint32_t i = start; i != head; i++) {
+        out.write((const uint8_t *)&traceRing[i & (TRACE_EVENTS - 1)], sizeof(TRACE_EVENT));
+    }
+
+    // 已导出的事件不再重复导出
+    traceHead.store(0, std::memory_order_relaxed);
+    tracePaused.store(false, std::memory_order_relaxed);
+}
+
+void traceDumpSerial()
+{
+    TraceHexPrint out;
+
+    Serial.write((const uint8_t *)"TRACE:BEGIN\r\n", 13);
+    traceDump(out);
+    out.finish();
+    Serial.write((const uint8_t *)"TRACE:END\r\n", 11);
+}
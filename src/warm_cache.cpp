@@ -0,0 +1,228 @@
+#include "warm_cache.h"
+#include "hal.h"
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <Preferences.h>
+#else
+// env:native没有RTC内存和NVS, 快照只在进程内有效
+#define RTC_NOINIT_ATTR
+#endif
+
+// RTC内存快照的最短写入间隔 (毫秒)
+#ifndef WARM_CACHE_RTC_PERIOD
+#define WARM_CACHE_RTC_PERIOD (5 * 1000)
+#endif
+// NVS快照的最短写入间隔 (毫秒), 限制flash写入次数
+#ifndef WARM_CACHE_NVS_PERIOD
+#define WARM_CACHE_NVS_PERIOD (15 * 60 * 1000)
+#endif
+
+#define WARM_CACHE_SIZE 1536
+#define WARM_CACHE_MAGIC 0x4d524157     // "WARM"
+#define WARM_CACHE_VERSION 1
+#define WARM_NVS_NAMESPACE "warm"
+#define WARM_NVS_KEY "snapshot"
+
+// 快照: 头 + 每项 numeric(1字节) id\0 label\0 prefix\0 unit\0 value\0
+typedef struct
+{
+    uint32_t magic;
+    uint8_t version;
+    uint8_t count;
+    uint16_t length;        // 负载长度
+    uint32_t checksum;      // 负载的FNV-1a
+} WARM_HEADER;
+
+typedef struct
+{
+    WARM_HEADER header;
+    uint8_t payload[WARM_CACHE_SIZE - sizeof(WARM_HEADER)];
+} WARM_SNAPSHOT;
+
+// 软复位后保留, 上电时内容随机, 靠magic和校验判断
+RTC_NOINIT_ATTR static WARM_SNAPSHOT rtcSnapshot;
+
+static WARM_SNAPSHOT snapshot;
+static std::vector<AIDA64_LAYOUT_ITEM> cachedLayout;
+static uint32_t cachedLayoutHash = 0;
+static unsigned long lastRtcWrite = 0;
+static unsigned long lastNvsWrite = 0;
+static bool nvsWritten = false;
+
+static uint32_t checksum(const uint8_t *data, size_t len)
+{
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static bool validSnapshot(const WARM_SNAPSHOT &s)
+{
+    return s.header.magic == WARM_CACHE_MAGIC &&
+           s.header.version == WARM_CACHE_VERSION &&
+           s.header.length <= sizeof(s.payload) &&
+           s.header.checksum == checksum(s.payload, s.header.length);
+}
+
+static bool putString(uint8_t *&out, const uint8_t *end, const char *str)
+{
+    size_t len = strlen(str) + 1;
+
+    if (out + len > end) {
+        return false;
+    }
+    memcpy(out, str, len);
+    out += len;
+    return true;
+}
+
+static bool getString(const uint8_t *&in, const uint8_t *end, char *str, size_t size)
+{
+    const uint8_t *zero = (const uint8_t *)memchr(in, '\0', end - in);
+
+    if (zero == NULL) {
+        return false;
+    }
+    snprintf(str, size, "%s", (const char *)in);
+    in = zero + 1;
+    return true;
+}
+
+static bool encode(const std::vector<AIDA64_DATA> &frame)
+{
+    uint8_t *out = snapshot.payload;
+    const uint8_t *end = snapshot.payload + sizeof(snapshot.payload);
+    uint8_t count = 0;
+
+    for (const auto &item : cachedLayout) {
+        const char *value = "";
+        for (const auto &data : frame) {
+            if (strcmp(data.id, item.id) == 0) {
+                value = data.val;
+                break;
+            }
+        }
+
+        if (out + 1 > end) return false;
+        *out++ = item.numeric;
+        if (!putString(out, end, item.id) || !putString(out, end, item.label) ||
+            !putString(out, end, item.prefix) || !putString(out, end, item.unit) || !putString(out, end, value)) {
+            return false;
+        }
+        count++;
+    }
+
+    snapshot.header.magic = WARM_CACHE_MAGIC;
+    snapshot.header.version = WARM_CACHE_VERSION;
+    snapshot.header.count = count;
+    snapshot.header.length = out - snapshot.payload;
+    snapshot.header.checksum = checksum(snapshot.payload, snapshot.header.length);
+    return true;
+}
+
+static bool decode(const WARM_SNAPSHOT &s, std::vector<AIDA64_LAYOUT_ITEM> &layout, std::vector<AIDA64_DATA> &frame)
+{
+    const uint8_t *in = s.payload;
+    const uint8_t *end = s.payload + s.header.length;
+    AIDA64_LAYOUT_ITEM item;
+    AIDA64_DATA data;
+
+    layout.clear();
+    frame.clear();
+    for (int i = 0; i < s.header.count; i++) {
+        memset(&item, 0, sizeof(item));
+        memset(&data, 0, sizeof(data));
+
+        if (in >= end) return false;
+        item.numeric = *in++;
+        if (!getString(in, end, item.id, sizeof(item.id)) ||
+            !getString(in, end, item.label, sizeof(item.label)) ||
+            !getString(in, end, item.prefix, sizeof(item.prefix)) ||
+            !getString(in, end, item.unit, sizeof(item.unit)) ||
+            !getString(in, end, data.val, sizeof(data.val))) {
+            return false;
+        }
+
+        layout.push_back(item);
+        if (data.val[0] != '\0') {
+            memcpy(data.id, item.id, sizeof(data.id));
+            frame.push_back(data);
+        }
+    }
+    return !layout.empty();
+}
+
+bool warmCacheLoad(std::vector<AIDA64_LAYOUT_ITEM> &layout, std::vector<AIDA64_DATA> &frame)
+{
+    if (validSnapshot(rtcSnapshot) && decode(rtcSnapshot, layout, frame)) {
+        warmPrintLog("Loaded %u items from RTC memory\r\n", (unsigned)layout.size());
+        return true;
+    }
+
+    bool loaded = false;
+#ifdef ARDUINO
+    Preferences prefs;
+    if (prefs.begin(WARM_NVS_NAMESPACE, true)) {
+        size_t len = prefs.getBytes(WARM_NVS_KEY, &snapshot, sizeof(snapshot));
+        prefs.end();
+        loaded = len >= sizeof(WARM_HEADER) && validSnapshot(snapshot) && decode(snapshot, layout, frame);
+    }
+#endif
+
+    if (loaded) {
+        warmPrintLog("Loaded %u items from NVS\r\n", (unsigned)layout.size());
+    } else {
+        warmPrintLog("No snapshot\r\n");
+    }
+    return loaded;
+}
+
+void warmCacheUpdate(const std::vector<AIDA64_DATA> &frame)
+{
+    unsigned long now = halMillis();
+    bool rtcDue = now - lastRtcWrite >= WARM_CACHE_RTC_PERIOD;
+    // 本次开机的第一帧立即写入NVS, 之后按周期
+    bool nvsDue = !nvsWritten || now - lastNvsWrite >= WARM_CACHE_NVS_PERIOD;
+
+    if (!rtcDue && !nvsDue) {
+        return;
+    }
+
+    uint32_t hash = getAida64LayoutHash();
+    if (hash == 0) {
+        // 布局尚未从AIDA64发现, 帧与布局可能不对应
+        return;
+    }
+    if (hash != cachedLayoutHash) {
+        cachedLayoutHash = copyAida64Layout(cachedLayout);
+    }
+
+    if (!encode(frame)) {
+        warmPrintLog("Snapshot exceeds %d bytes, skipped\r\n", WARM_CACHE_SIZE);
+        return;
+    }
+
+    if (rtcDue) {
+        memcpy(&rtcSnapshot, &snapshot, sizeof(WARM_HEADER) + snapshot.header.length);
+        lastRtcWrite = now;
+    }
+
+    if (nvsDue) {
+#ifdef ARDUINO
+        Preferences prefs;
+        if (prefs.begin(WARM_NVS_NAMESPACE, false)) {
+            prefs.putBytes(WARM_NVS_KEY, &snapshot, sizeof(WARM_HEADER) + snapshot.header.length);
+            prefs.end();
+        }
+#endif
+        lastNvsWrite = now;
+        nvsWritten = true;
+    }
+}
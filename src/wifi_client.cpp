@@ -1,88 +1,168 @@
 #include "config.h"
 #include "display.h"
 #include "wifi_client.h"
+#include "wifi_state.h"
+#include "metrics.h"
+#include "wifi_power.h"
+#include <Preferences.h>
 
-typedef enum
+#define WIFI_NVS_NAMESPACE "wifi"
+#define WIFI_NVS_KEY "cache"
+#define WIFI_EVENT_QUEUE 8
+#define WIFI_TICK_MS 100
+
+static_assert(WIFI_REASON_ASSOC_LEAVE == WIFI_SM_REASON_ASSOC_LEAVE, "wifi_state.h must match ESP-IDF reason codes");
+
+// WiFi事件在系统事件任务中回调, 只转发到WiFi任务的队列
+static QueueHandle_t wifiEventQueue = NULL;
+
+static uint32_t lastConnectMs[WIFI_PATH_MAX];
+static uint32_t connectCount[WIFI_PATH_MAX];
+
+static const char *pathNames[WIFI_PATH_MAX] = {
+    "fast",
+    "scan",
+};
+
+class Esp32WifiDriver : public WifiDriver {
+public:
+    void connect(const WIFI_CACHE *cache) override {
+        if (cache) {
+            // 指定BSSID和信道跳过扫描, 沿用上次的IP配置跳过DHCP
+            WiFi.config(IPAddress(cache->ip), IPAddress(cache->gateway), IPAddress(cache->subnet), IPAddress(cache->dns));
+            WiFi.begin(WIFI_SSID, WIFI_PASS, cache->channel, cache->bssid);
+            wifiPrintLog("Fast connect to " WIFI_SSID " (channel %d)\r\n", cache->channel);
+        } else {
+            WiFi.config(INADDR_NONE, INADDR_NONE, INADDR_NONE);
+            WiFi.begin(WIFI_SSID, WIFI_PASS);
+            wifiPrintLog("Connect to " WIFI_SSID "\r\n");
+        }
+    }
+
+    bool readCache(WIFI_CACHE &cache) override {
+        uint8_t *bssid = WiFi.BSSID();
+        if (bssid == NULL) {
+            return false;
+        }
+        memcpy(cache.bssid, bssid, sizeof(cache.bssid));
+        cache.channel = WiFi.channel();
+        cache.ip = WiFi.localIP();
+        cache.gateway = WiFi.gatewayIP();
+        cache.subnet = WiFi.subnetMask();
+        cache.dns = WiFi.dnsIP();
+        return true;
+    }
+
+    bool loadCache(WIFI_CACHE &cache) override {
+        Preferences prefs;
+        bool ok = false;
+
+        if (prefs.begin(WIFI_NVS_NAMESPACE, true)) {
+            ok = prefs.getBytes(WIFI_NVS_KEY, &cache, sizeof(cache)) == sizeof(cache);
+            prefs.end();
+        }
+        return ok;
+    }
+
+    void saveCache(const WIFI_CACHE &cache) override {
+        Preferences prefs;
+
+        if (prefs.begin(WIFI_NVS_NAMESPACE, false)) {
+            prefs.putBytes(WIFI_NVS_KEY, &cache, sizeof(cache));
+            prefs.end();
+        }
+        wifiPrintLog("Connect cache %s\r\n", cache.valid ? "saved" : "cleared");
+    }
+
+    void setOffline(bool offline) override {
+        //60s未连接关闭屏幕
+        display_enhanced.setPowerSave(offline ? 1 : 0);
+        if (offline) {
+            wifiPrintLog("Screen enter PowerSave Mode\r\n");
+        }
+    }
+
+    void onConnected(WIFI_CONNECT_PATH path, uint32_t connect_ms) override {
+        lastConnectMs[path] = connect_ms;
+        connectCount[path]++;
+        wifiPrintLog("Wifi Connect succeed! (%s, %ums, %s)\r\n", pathNames[path], connect_ms,
+                     WiFi.localIP().toString().c_str());
+    }
+
+    void onReconnect() override {
+        wifiPrintLog("Reconnect to " WIFI_SSID "\r\n");
+        metricsInc(METRIC_WIFI_RECONNECTS);
+    }
+};
+
+static void onWifiEvent(WiFiEvent_t event, WiFiEventInfo_t info)
 {
-    WIFI_NOT_INIT,
-    WIFI_CONNECTING,
-    WIFI_CONNECTED,
-    WIFI_STATUS_MAX,
-}WIFI_STATUS;
+    WIFI_SM_EVENT smEvent;
+
+    switch (event) {
+        case ARDUINO_EVENT_WIFI_STA_CONNECTED:
+            smEvent = WIFI_SM_ASSOCIATED;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+            smEvent = WIFI_SM_GOT_IP;
+            break;
+        case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+            if (!wifiDisconnectIsFailure(info.wifi_sta_disconnected.reason)) {
+                return;
+            }
+            smEvent = WIFI_SM_DISCONNECTED;
+            break;
+        default:
+            return;
+    }
+
+    xQueueSend(wifiEventQueue, &smEvent, 0);
+}
 
 void taskWifiClient(void *param)
 {
-    unsigned long reconnectTick = 0;
-    unsigned long connectBeginTick = 0;
-    unsigned long connectingTick = 0;
-    int wifiStatus = WIFI_NOT_INIT;
+    Esp32WifiDriver driver;
+    WifiStateMachine machine(driver);
+    WIFI_SM_EVENT event;
+    WIFI_SM_STATE lastState = WIFI_SM_IDLE;
 
     wifiPrintLog("taskWifiClient run!\r\n");
 
-    while(1)
-    {
-        if(WiFi.status() != WL_CONNECTED)
-        {
-            if(wifiStatus == WIFI_NOT_INIT)
-            {
-                wifiStatus = WIFI_CONNECTING;
-
-                WiFi.begin(WIFI_SSID, WIFI_PASS);
-                wifiPrintLog("Connect to " WIFI_SSID "\r\n");
-                connectBeginTick = millis();
-            }
-
-            if(wifiStatus == WIFI_CONNECTED)
-            {
-                wifiStatus = WIFI_CONNECTING;
+    wifiEventQueue = xQueueCreate(WIFI_EVENT_QUEUE, sizeof(WIFI_SM_EVENT));
+    WiFi.onEvent(onWifiEvent);
 
-                wifiPrintLog("Disconnect!\r\n");
-                wifiPrintLog("Reconnect to " WIFI_SSID "\r\n");
+    // 重连完全由状态机控制, 避免与WiFi库的自动重连冲突, 也不让WiFi库写flash
+    WiFi.persistent(false);
+    WiFi.setAutoReconnect(false);
+    WiFi.mode(WIFI_STA);
 
-                WiFi.reconnect();
-                connectBeginTick = millis();
-            }
+    machine.start(millis());
 
-            if(wifiStatus == WIFI_CONNECTING)
-            {
-                if(getElapsedTick(connectingTick) >= 1000)
-                {
-                    wifiPrintLog("Connecting...\r\n");
-                    connectingTick = millis();
-                }
-
-                if(getElapsedTick(reconnectTick) >= 15000)
-                {
-                    wifiPrintLog("Connect timeout!\r\n");
-                    wifiPrintLog("Reconnect\r\n");
-
-                    WiFi.reconnect();
-                    reconnectTick = millis();
-                }
-
-                if(getElapsedTick(connectBeginTick) >= 60000)
-                {
-                    display_enhanced.setPowerSave(1);//60s未连接关闭屏幕
-                    wifiPrintLog("Screen enter PowerSave Mode\r\n");
-                }
-            }
+    while(1)
+    {
+        if (xQueueReceive(wifiEventQueue, &event, pdMS_TO_TICKS(WIFI_TICK_MS)) == pdTRUE) {
+            machine.onEvent(event, millis());
         }
-        else
-        {
-            if(wifiStatus == WIFI_CONNECTING)
-            {
-                wifiStatus = WIFI_CONNECTED;
-                wifiPrintLog("Wifi Connect succeed!\r\n");
-
-                display_enhanced.setPowerSave(0);
-            }
+        machine.tick(millis());
+        wifiPowerPolicy.service(machine.getState() == WIFI_SM_CONNECTED);
+
+        if (machine.getState() != lastState) {
+            wifiPrintLog("%s -> %s\r\n", WifiStateMachine::stateName(lastState),
+                         WifiStateMachine::stateName(machine.getState()));
+            lastState = machine.getState();
         }
+    }
+}
 
-        delay(100);
+uint32_t getWifiConnectMs(WIFI_CONNECT_PATH path, uint32_t *count)
+{
+    if (count) {
+        *count = connectCount[path];
     }
+    return lastConnectMs[path];
 }
 
 unsigned long getElapsedTick(unsigned long lastTick)
 {
     return (millis() - lastTick);
-}
\ No newline at end of file
+}
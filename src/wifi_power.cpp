@@ -0,0 +1,174 @@
+#include "wifi_power.h"
+#include "power_manager.h"
+#include <WiFi.h>
+#include <algorithm>
+
+// 多久没有数据视为数据流中断 (毫秒), 默认与背光调暗一致
+#ifndef WIFI_PS_IDLE_TIMEOUT
+#define WIFI_PS_IDLE_TIMEOUT POWER_DIM_TIMEOUT
+#endif
+// 允许的到达抖动 (p90, 毫秒), 超出则退回不省电
+#ifndef WIFI_PS_JITTER_BUDGET
+#define WIFI_PS_JITTER_BUDGET 30
+#endif
+// 试探modem sleep的间隔 (毫秒)
+#ifndef WIFI_PS_PROBE_INTERVAL
+#define WIFI_PS_PROBE_INTERVAL (10 * 60 * 1000)
+#endif
+// 帧间隔中位数低于该值时不试探, 高频数据流省电收益小
+#define WIFI_PS_MIN_INTERVAL 500
+// 判断试探结果所需的最少样本数
+#define WIFI_PS_PROBE_SAMPLES 16
+
+static const char *modeNames[WIFI_PS_MODE_MAX] = {
+    "none",
+    "modem",
+};
+
+WifiPowerPolicy::WifiPowerPolicy() {
+    memset(stats, 0, sizeof(stats));
+    last_arrival_us = 0;
+    last_frame_ms = 0;
+    mode = WIFI_PS_MODE_MODEM;
+    applied = false;
+    probing = false;
+    next_probe = WIFI_PS_PROBE_INTERVAL;
+    probe_start_count = 0;
+}
+
+const char *WifiPowerPolicy::modeName(WIFI_PS_MODE mode) {
+    return modeNames[mode];
+}
+
+void WifiPowerPolicy::onFrame(uint32_t arrival_us) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (last_arrival_us != 0) {
+        uint32_t interval_ms = (arrival_us - last_arrival_us) / 1000;
+        WIFI_PS_STATS &s = stats[mode];
+
+        // 数据流中断后的第一帧不计入
+        if (interval_ms < WIFI_PS_IDLE_TIMEOUT) {
+            s.interval_ms[s.next] = interval_ms;
+            s.next = (s.next + 1) % WIFI_PS_SAMPLES;
+            if (s.filled < WIFI_PS_SAMPLES) s.filled++;
+            s.count++;
+            s.sum_ms += interval_ms;
+        }
+    }
+
+    last_arrival_us = arrival_us;
+    last_frame_ms = millis();
+}
+
+void WifiPowerPolicy::summarize(const WIFI_PS_STATS &s, WIFI_PS_SUMMARY &summary) {
+    uint16_t sorted[WIFI_PS_SAMPLES];
+    uint16_t n = s.filled;
+
+    memset(&summary, 0, sizeof(summary));
+    summary.count = s.count;
+    summary.sum_ms = s.sum_ms;
+    if (n == 0) {
+        return;
+    }
+
+    memcpy(sorted, s.interval_ms, n * sizeof(sorted[0]));
+    std::sort(sorted, sorted + n);
+    summary.p50_ms = sorted[n * 50 / 100];
+    summary.p90_ms = sorted[n * 90 / 100];
+    summary.p99_ms = sorted[n * 99 / 100];
+
+    for (uint16_t i = 0; i < n; i++) {
+        int32_t diff = (int32_t)s.interval_ms[i] - (int32_t)summary.p50_ms;
+        sorted[i] = diff < 0 ? -diff : diff;
+    }
+    std::sort(sorted, sorted + n);
+    summary.jitter_p90_ms = sorted[n * 90 / 100];
+}
+
+void WifiPowerPolicy::getSummary(WIFI_PS_MODE m, WIFI_PS_SUMMARY &summary) {
+    std::lock_guard<std::mutex> guard(lock);
+    summarize(stats[m], summary);
+}
+
+void WifiPowerPolicy::setMode(WIFI_PS_MODE next, const char *reason) {
+    if (applied && next == mode) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        mode = next;
+        // 切换后的第一个间隔跨越两种模式, 不计入
+        last_arrival_us = 0;
+    }
+
+    WiFi.setSleep(next == WIFI_PS_MODE_MODEM);
+    applied = true;
+    wifiPowerPrintLog("Power save -> %s (%s)\r\n", modeNames[next], reason);
+}
+
+void WifiPowerPolicy::service(bool connected) {
+    unsigned long now = millis();
+    bool streaming;
+    WIFI_PS_SUMMARY summary;
+
+    if (!connected) {
+        // 重新连接后重新应用当前模式
+        applied = false;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        streaming = last_frame_ms != 0 && now - last_frame_ms < WIFI_PS_IDLE_TIMEOUT;
+    }
+
+    if (!streaming) {
+        probing = false;
+        setMode(WIFI_PS_MODE_MODEM, "no data");
+        return;
+    }
+
+    if (mode == WIFI_PS_MODE_MODEM && !probing) {
+        // 数据恢复: 先以最低延迟接收, 稍后再试探
+        next_probe = now + WIFI_PS_PROBE_INTERVAL;
+        setMode(WIFI_PS_MODE_NONE, "streaming");
+        return;
+    }
+
+    if (mode == WIFI_PS_MODE_NONE) {
+        if ((long)(now - next_probe) < 0) {
+            return;
+        }
+        next_probe = now + WIFI_PS_PROBE_INTERVAL;
+
+        getSummary(WIFI_PS_MODE_NONE, summary);
+        if (summary.p50_ms >= WIFI_PS_MIN_INTERVAL) {
+            {
+                // 只按本次试探的样本判断
+                std::lock_guard<std::mutex> guard(lock);
+                stats[WIFI_PS_MODE_MODEM].next = 0;
+                stats[WIFI_PS_MODE_MODEM].filled = 0;
+                probe_start_count = stats[WIFI_PS_MODE_MODEM].count;
+            }
+            probing = true;
+            setMode(WIFI_PS_MODE_MODEM, "probe");
+        }
+        return;
+    }
+
+    // 试探中: 样本足够后按抖动决定保留还是退回
+    getSummary(WIFI_PS_MODE_MODEM, summary);
+    if (summary.count - probe_start_count >= WIFI_PS_PROBE_SAMPLES &&
+        summary.jitter_p90_ms > WIFI_PS_JITTER_BUDGET) {
+        wifiPowerPrintLog("Modem sleep jitter p90 %ums over budget %ums\r\n",
+                          summary.jitter_p90_ms, WIFI_PS_JITTER_BUDGET);
+        probing = false;
+        next_probe = now + WIFI_PS_PROBE_INTERVAL;
+        setMode(WIFI_PS_MODE_NONE, "jitter");
+    }
+}
+
+// 全局实例
+WifiPowerPolicy wifiPowerPolicy;
@@ -0,0 +1,135 @@
+#include "wifi_state.h"
+#include <string.h>
+
+// 快速连接失败的判定时间, 超时后退回完整扫描
+#ifndef WIFI_FAST_TIMEOUT
+#define WIFI_FAST_TIMEOUT 3000
+#endif
+// 完整扫描连接的超时, 超时后重新发起
+#ifndef WIFI_SCAN_TIMEOUT
+#define WIFI_SCAN_TIMEOUT 15000
+#endif
+// 持续未连接多久后关闭屏幕
+#ifndef WIFI_OFFLINE_TIMEOUT
+#define WIFI_OFFLINE_TIMEOUT 60000
+#endif
+
+static const char *stateNames[WIFI_SM_STATE_MAX] = {
+    "idle",
+    "fast-connect",
+    "scan-connect",
+    "connected",
+};
+
+WifiStateMachine::WifiStateMachine(WifiDriver &driver) : driver(driver) {
+    state = WIFI_SM_IDLE;
+    memset(&cache, 0, sizeof(cache));
+    attempt_start = 0;
+    offline_start = 0;
+    offline = false;
+}
+
+bool wifiDisconnectIsFailure(uint8_t reason) {
+    return reason != WIFI_SM_REASON_ASSOC_LEAVE;
+}
+
+const char *WifiStateMachine::stateName(WIFI_SM_STATE state) {
+    return state < WIFI_SM_STATE_MAX ? stateNames[state] : "?";
+}
+
+void WifiStateMachine::enterState(WIFI_SM_STATE next) {
+    state = next;
+}
+
+void WifiStateMachine::connectFast(uint32_t now_ms) {
+    attempt_start = now_ms;
+    enterState(WIFI_SM_FAST_CONNECT);
+    driver.connect(&cache);
+}
+
+void WifiStateMachine::connectScan(uint32_t now_ms) {
+    attempt_start = now_ms;
+    enterState(WIFI_SM_SCAN_CONNECT);
+    driver.connect(NULL);
+}
+
+void WifiStateMachine::start(uint32_t now_ms) {
+    offline_start = now_ms;
+
+    if (driver.loadCache(cache) && cache.valid) {
+        connectFast(now_ms);
+    } else {
+        cache.valid = 0;
+        connectScan(now_ms);
+    }
+}
+
+void WifiStateMachine::onEvent(WIFI_SM_EVENT event, uint32_t now_ms) {
+    switch (event) {
+        case WIFI_SM_ASSOCIATED:
+            break;
+
+        case WIFI_SM_GOT_IP:
+            if (state != WIFI_SM_FAST_CONNECT && state != WIFI_SM_SCAN_CONNECT) {
+                break;
+            }
+
+            driver.onConnected(state == WIFI_SM_FAST_CONNECT ? WIFI_PATH_FAST : WIFI_PATH_SCAN,
+                               now_ms - offline_start);
+
+            // 完整连接后更新缓存, AP或IP变化时才写入
+            if (state == WIFI_SM_SCAN_CONNECT) {
+                WIFI_CACHE current;
+                memset(&current, 0, sizeof(current));
+                if (driver.readCache(current)) {
+                    current.valid = 1;
+                    if (memcmp(&current, &cache, sizeof(cache)) != 0) {
+                        cache = current;
+                        driver.saveCache(cache);
+                    }
+                }
+            }
+
+            enterState(WIFI_SM_CONNECTED);
+            if (offline) {
+                offline = false;
+                driver.setOffline(false);
+            }
+            break;
+
+        case WIFI_SM_DISCONNECTED:
+            if (state == WIFI_SM_CONNECTED) {
+                // AP短暂中断: 先按缓存直接重连
+                offline_start = now_ms;
+                driver.onReconnect();
+                if (cache.valid) {
+                    connectFast(now_ms);
+                } else {
+                    connectScan(now_ms);
+                }
+            } else if (state == WIFI_SM_FAST_CONNECT) {
+                // AP换了信道或BSSID, 缓存失效
+                cache.valid = 0;
+                driver.saveCache(cache);
+                connectScan(now_ms);
+            }
+            // 扫描连接中的断开 (找不到AP、认证失败) 不立即重试: WiFi库的自动重连已关闭,
+            // 由 WIFI_SCAN_TIMEOUT 超时后重新发起, 避免AP不在时连续扫描
+            break;
+    }
+}
+
+void WifiStateMachine::tick(uint32_t now_ms) {
+    if (state == WIFI_SM_FAST_CONNECT && now_ms - attempt_start >= WIFI_FAST_TIMEOUT) {
+        connectScan(now_ms);
+    } else if (state == WIFI_SM_SCAN_CONNECT && now_ms - attempt_start >= WIFI_SCAN_TIMEOUT) {
+        driver.onReconnect();
+        connectScan(now_ms);
+    }
+
+    if (state != WIFI_SM_CONNECTED && state != WIFI_SM_IDLE && !offline &&
+        now_ms - offline_start >= WIFI_OFFLINE_TIMEOUT) {
+        offline = true;
+        driver.setOffline(true);
+    }
+}
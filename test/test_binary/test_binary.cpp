@@ -0,0 +1,158 @@
+/*
+ * 紧凑二进制协议: 编码 -> 分帧 -> 解码的往返, 以及同步状态的处理
+ *   pio test -e native -f test_binary
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "aida64_binary.h"
+
+static AIDA64_STREAM stream;
+static AIDA64_BIN_ENCODER encoder;
+static AIDA64_BIN_DECODER decoder;
+static std::vector<AIDA64_LAYOUT_ITEM> layout;
+static std::vector<AIDA64_DATA> dataList;
+static uint8_t out[AIDA64_BIN_MAX_FRAME];
+
+static AIDA64_LAYOUT_ITEM makeItem(const char *id, const char *label, const char *prefix, const char *unit,
+                                   uint8_t numeric)
+{
+    AIDA64_LAYOUT_ITEM item;
+
+    memset(&item, 0, sizeof(item));
+    strcpy(item.id, id);
+    strcpy(item.label, label);
+    strcpy(item.prefix, prefix);
+    strcpy(item.unit, unit);
+    item.numeric = numeric;
+    return item;
+}
+
+static AIDA64_DATA makeData(const char *id, const char *val)
+{
+    AIDA64_DATA data;
+
+    memset(&data, 0, sizeof(data));
+    strcpy(data.id, id);
+    strcpy(data.val, val);
+    return data;
+}
+
+// 写入流缓冲区后取出一个完整帧
+static AIDA64_BIN_FRAME nextFrame(const uint8_t *bytes, size_t len)
+{
+    AIDA64_BIN_FRAME frame;
+    size_t space;
+    char *writePtr = aida64StreamWritePtr(stream, &space);
+
+    TEST_ASSERT_TRUE(len > 0 && len <= space);
+    memcpy(writePtr, bytes, len);
+    aida64StreamCommit(stream, len);
+    TEST_ASSERT_TRUE(aida64BinaryNextFrame(stream, frame));
+    return frame;
+}
+
+// 与SSE数据相同的写法: 标签去掉空格后紧接数值
+static bool decodeValues(const char *cpu, const char *ip)
+{
+    char cpuText[64];
+    char ipText[64];
+
+    snprintf(cpuText, sizeof(cpuText), "CPUUsage%s%%", cpu);
+    snprintf(ipText, sizeof(ipText), "LocalIP%s", ip);
+    std::vector<AIDA64_DATA> input = {makeData("Simple1", cpuText), makeData("Simple2", ipText)};
+    size_t len = aida64BinaryEncodeData(encoder, input, out, sizeof(out));
+    return aida64BinaryDecodeData(decoder, nextFrame(out, len), dataList);
+}
+
+void setUp(void)
+{
+    std::vector<AIDA64_LAYOUT_ITEM> source = {makeItem("Simple1", "CPU Usage", "CPUUsage", "%", 1),
+                                                makeItem("Simple2", "Local IP", "LocalIP", "", 0)};
+
+    aida64StreamReset(stream);
+    aida64BinaryDecoderReset(decoder);
+    aida64BinaryEncoderInit(encoder, source, 0, false);
+    layout.clear();
+    dataList.clear();
+
+    size_t len = aida64BinaryEncodeLayout(encoder, out, sizeof(out));
+    TEST_ASSERT_TRUE(aida64BinaryDecodeLayout(decoder, nextFrame(out, len), layout));
+}
+
+void tearDown(void)
+{
+}
+
+static void test_layout_round_trip(void)
+{
+    TEST_ASSERT_EQUAL_size_t(2, layout.size());
+    TEST_ASSERT_EQUAL_STRING("Simple1", layout[0].id);
+    TEST_ASSERT_EQUAL_STRING("%", layout[0].unit);
+    TEST_ASSERT_EQUAL_UINT8(1, layout[0].numeric);
+    TEST_ASSERT_EQUAL_UINT8(0, layout[1].numeric);
+}
+
+static void test_keyframe_and_delta_round_trip(void)
+{
+    TEST_ASSERT_TRUE(decodeValues("24", "192.168.1.5"));
+    TEST_ASSERT_TRUE(decoder.synced);
+    TEST_ASSERT_EQUAL_size_t(2, dataList.size());
+    TEST_ASSERT_EQUAL_STRING(">24.00", dataList[0].val);
+    TEST_ASSERT_EQUAL_STRING(">192.168.1.5", dataList[1].val);
+
+    TEST_ASSERT_TRUE(decodeValues("-3.5", "192.168.1.5"));
+    TEST_ASSERT_EQUAL_STRING(">-3.50", dataList[0].val);
+    TEST_ASSERT_EQUAL_STRING(">192.168.1.5", dataList[1].val);
+}
+
+static void test_delta_gap_waits_for_keyframe(void)
+{
+    TEST_ASSERT_TRUE(decodeValues("24", "a"));
+
+    // 丢掉一个差分帧
+    std::vector<AIDA64_DATA> input = {makeData("Simple1", "CPUUsage25%")};
+    aida64BinaryEncodeData(encoder, input, out, sizeof(out));
+
+    TEST_ASSERT_FALSE(decodeValues("26", "a"));
+    TEST_ASSERT_FALSE(decoder.synced);
+
+    size_t len = aida64BinaryEncodeKeyframe(encoder, out, sizeof(out));
+    TEST_ASSERT_TRUE(aida64BinaryDecodeData(decoder, nextFrame(out, len), dataList));
+    TEST_ASSERT_EQUAL_STRING(">26.00", dataList[0].val);
+}
+
+// 未知类型的帧 (例如新版本的中继) 被忽略, 不改变同步状态和序号
+static void test_unknown_frame_type_keeps_sync(void)
+{
+    TEST_ASSERT_TRUE(decodeValues("24", "a"));
+    uint16_t seq = decoder.seq;
+
+    std::vector<AIDA64_DATA> input = {makeData("Simple1", "CPUUsage99%")};
+    size_t len = aida64BinaryEncodeData(encoder, input, out, sizeof(out));
+    out[2] = 0x7f;
+    TEST_ASSERT_FALSE(aida64BinaryDecodeData(decoder, nextFrame(out, len), dataList));
+    TEST_ASSERT_TRUE(decoder.synced);
+    TEST_ASSERT_EQUAL_UINT16(seq, decoder.seq);
+    TEST_ASSERT_EQUAL_STRING(">24.00", decoder.frame[0].val);
+
+    // 未同步时也不会因此进入同步
+    aida64BinaryDecoderReset(decoder);
+    aida64BinaryDecodeLayout(decoder, nextFrame(out, aida64BinaryEncodeLayout(encoder, out, sizeof(out))), layout);
+    len = aida64BinaryEncodeKeyframe(encoder, out, sizeof(out));
+    out[2] = AIDA64_BIN_LAYOUT;
+    TEST_ASSERT_FALSE(aida64BinaryDecodeData(decoder, nextFrame(out, len), dataList));
+    TEST_ASSERT_FALSE(decoder.synced);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_layout_round_trip);
+    RUN_TEST(test_keyframe_and_delta_round_trip);
+    RUN_TEST(test_delta_gap_waits_for_keyframe);
+    RUN_TEST(test_unknown_frame_type_keeps_sync);
+    return UNITY_END();
+}
@@ -0,0 +1,251 @@
+/*
+ * 定点格式化与原 snprintf 版本 (display.cpp 的 formatValue) 的逐值比较, 以及两者的耗时
+ *   pio test -e native -f test_fixed_format -v
+ *
+ * 参考实现用double计算并按 %.Nf 输出. 定点版本对恰好的十进制中点 (例如 0.25 -> 0.3) 远离0舍入,
+ * 而浮点数只能近似表示这些中点, 所以参考值在舍入前向远离0的方向推一个远小于最小刻度的量
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "fixed_format.h"
+
+typedef struct
+{
+    const char *unit;
+    int64_t first;      // 输入按 decimals 位小数缩放后的范围
+    int64_t last;
+    uint8_t decimals;   // AIDA64文本中的小数位数
+} SWEEP_RANGE;
+
+// 显示的各单位在实际可能出现的范围内逐个取值
+static const SWEEP_RANGE sweepRanges[] = {
+    {"%",    0,       10000,   2},  // 0.00 - 100.00
+    {"°C",   -4000,   15000,   2},  // -40.00 - 150.00
+    {"MHz",  0,       1000000, 2},  // 0.00 - 10000.00
+    {"MB",   0,       262144,  0},  // 0 - 256 GB
+    {"MB",   0,       409600,  2},  // 0.00 - 4096.00
+    {"W",    -10000,  200000,  2},  // -100.00 - 2000.00
+    {"KB/s", 0,       1310720, 1},  // 0.0 - 131072.0
+    {"KB/s", 0,       409600,  2},  // 0.00 - 4096.00
+    {"V",    0,       3000,    3},  // 0.000 - 3.000, 比定点多一位小数
+    {"",     -100000, 100000,  2},
+};
+
+// 远小于任何输出刻度与输入之间的距离 (>= 1e-5), 又远大于double在这些量级上的误差
+#define REFERENCE_NUDGE 1e-9
+
+static double nudge(double value)
+{
+    return value + copysign(REFERENCE_NUDGE, value);
+}
+
+static void formatReference(double value, const char *unit, char *buf, size_t size)
+{
+    if (strcmp(unit, "%") == 0) {
+        snprintf(buf, size, "%.1f%%", nudge(value));
+    } else if (strcmp(unit, "MB") == 0) {
+        if (value >= 1024.0) {
+            snprintf(buf, size, "%.1f GB", nudge(value / 1024.0));
+        } else {
+            snprintf(buf, size, "%.0f MB", nudge(value));
+        }
+    } else if (strcmp(unit, "MHz") == 0) {
+        if (value >= 1000.0) {
+            snprintf(buf, size, "%.2f GHz", nudge(value / 1000.0));
+        } else {
+            snprintf(buf, size, "%.0f MHz", nudge(value));
+        }
+    } else if (strcmp(unit, "KB/s") == 0 && value >= 1024.0) {
+        snprintf(buf, size, "%.1f MB/s", nudge(value / 1024.0));
+    } else if (strchr(unit, 'C') != NULL && strchr(unit, '/') == NULL) {
+        snprintf(buf, size, "%.0f%s", nudge(value), unit);
+    } else if (unit[0] != '\0') {
+        snprintf(buf, size, "%.1f %s", nudge(value), unit);
+    } else {
+        snprintf(buf, size, "%.1f", nudge(value));
+    }
+}
+
+// 按AIDA64的写法生成输入文本, 例如 scaled=-5, decimals=2 -> "-0.05"
+static void makeInput(char *buf, size_t size, int64_t scaled, uint8_t decimals)
+{
+    char digits[24];
+    size_t count = 0;
+    size_t len = 0;
+    uint64_t magnitude = scaled < 0 ? -scaled : scaled;
+
+    do {
+        digits[count++] = '0' + magnitude % 10;
+        magnitude /= 10;
+    } while (magnitude > 0 || count <= decimals);
+
+    if (scaled < 0) {
+        buf[len++] = '-';
+    }
+    while (count > 0 && len + 2 < size) {
+        if (count == decimals) {
+            buf[len++] = '.';
+        }
+        buf[len++] = digits[--count];
+    }
+    buf[len] = '\0';
+}
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+static void test_sweep_matches_snprintf(void)
+{
+    char input[32];
+    char expected[32];
+    char actual[32];
+    char message[128];
+
+    for (const auto &range : sweepRanges) {
+        for (int64_t scaled = range.first; scaled <= range.last; scaled++) {
+            int32_t value;
+            makeInput(input, sizeof(input), scaled, range.decimals);
+            TEST_ASSERT_NOT_NULL(parseFixed(input, FIXED_DECIMALS, &value));
+
+            formatFixedUnit(actual, sizeof(actual), value, FIXED_DECIMALS, range.unit);
+            formatReference(strtod(input, NULL), range.unit, expected, sizeof(expected));
+            if (strcmp(expected, actual) != 0) {
+                snprintf(message, sizeof(message), "input \"%s\" unit \"%s\"", input, range.unit);
+                TEST_ASSERT_EQUAL_STRING_MESSAGE(expected, actual, message);
+            }
+        }
+    }
+}
+
+static void test_decimal_ties_round_away_from_zero(void)
+{
+    char buf[32];
+    int32_t value;
+
+    parseFixed("0.25", FIXED_DECIMALS, &value);
+    formatFixedUnit(buf, sizeof(buf), value, FIXED_DECIMALS, "W");
+    TEST_ASSERT_EQUAL_STRING("0.3 W", buf);
+
+    parseFixed("-0.25", FIXED_DECIMALS, &value);
+    formatFixedUnit(buf, sizeof(buf), value, FIXED_DECIMALS, "W");
+    TEST_ASSERT_EQUAL_STRING("-0.3 W", buf);
+
+    // 舍入到0的负数与printf一样保留负号
+    parseFixed("-0.04", FIXED_DECIMALS, &value);
+    formatFixedUnit(buf, sizeof(buf), value, FIXED_DECIMALS, "W");
+    TEST_ASSERT_EQUAL_STRING("-0.0 W", buf);
+}
+
+static void test_parse_stops_at_unit(void)
+{
+    int32_t value;
+    const char *end = parseFixed("3409.5MHz", FIXED_DECIMALS, &value);
+
+    TEST_ASSERT_NOT_NULL(end);
+    TEST_ASSERT_EQUAL_INT32(340950, value);
+    TEST_ASSERT_EQUAL_STRING("MHz", end);
+
+    TEST_ASSERT_NULL(parseFixed("---", FIXED_DECIMALS, &value));
+    TEST_ASSERT_NULL(parseFixed("", FIXED_DECIMALS, &value));
+}
+
+static void test_parse_clamps_out_of_range(void)
+{
+    int32_t value;
+
+    parseFixed("99999999999", FIXED_DECIMALS, &value);
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, value);
+    parseFixed("-99999999999", FIXED_DECIMALS, &value);
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, value);
+}
+
+static void test_format_truncates_to_buffer(void)
+{
+    char buf[6];
+
+    formatFixedUnit(buf, sizeof(buf), 12345678, FIXED_DECIMALS, "W");
+    TEST_ASSERT_EQUAL_STRING("12345", buf);
+
+    formatFixed(buf, 1, 100, FIXED_DECIMALS, 1);
+    TEST_ASSERT_EQUAL_STRING("", buf);
+}
+
+static void test_bar_value_truncates(void)
+{
+    TEST_ASSERT_EQUAL_INT32(24, fixedToInt(2499, FIXED_DECIMALS));
+    TEST_ASSERT_EQUAL_INT32(-1, fixedToInt(-199, FIXED_DECIMALS));
+}
+
+/*
+ * 基准: 与 applyBinding 中的每项更新相同, 解析文本再按单位格式化
+ */
+#define BENCH_ROUNDS 200000
+
+static const char *benchInputs[][2] = {
+    {"24", "%"}, {"41", "°C"}, {"3409", "MHz"}, {"8000", "MB"}, {"-0.5", "W"}, {"47.6", "KB/s"}, {"1480.2", "KB/s"},
+};
+
+static uint64_t nowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static void test_benchmark_against_snprintf(void)
+{
+    const size_t count = sizeof(benchInputs) / sizeof(benchInputs[0]);
+    char buf[32];
+    char message[128];
+    volatile size_t sink = 0;
+
+    uint64_t start = nowNs();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (size_t i = 0; i < count; i++) {
+            int32_t value;
+            parseFixed(benchInputs[i][0], FIXED_DECIMALS, &value);
+            sink += formatFixedUnit(buf, sizeof(buf), value, FIXED_DECIMALS, benchInputs[i][1]);
+        }
+    }
+    uint64_t fixedNs = nowNs() - start;
+
+    start = nowNs();
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        for (size_t i = 0; i < count; i++) {
+            // 原版本: strtof + float运算 + snprintf
+            float value = strtof(benchInputs[i][0], NULL);
+            formatReference(value, benchInputs[i][1], buf, sizeof(buf));
+            sink += buf[0];
+        }
+    }
+    uint64_t snprintfNs = nowNs() - start;
+
+    double calls = (double)BENCH_ROUNDS * count;
+    snprintf(message, sizeof(message), "fixed: %.1f ns/value, snprintf: %.1f ns/value (%.1fx)",
+             fixedNs / calls, snprintfNs / calls, (double)snprintfNs / fixedNs);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(sink > 0);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_sweep_matches_snprintf);
+    RUN_TEST(test_decimal_ties_round_away_from_zero);
+    RUN_TEST(test_parse_stops_at_unit);
+    RUN_TEST(test_parse_clamps_out_of_range);
+    RUN_TEST(test_format_truncates_to_buffer);
+    RUN_TEST(test_bar_value_truncates);
+    RUN_TEST(test_benchmark_against_snprintf);
+    return UNITY_END();
+}
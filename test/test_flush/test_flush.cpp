@@ -0,0 +1,121 @@
+/*
+ * 两种像素字节序的HAL刷新入口: 结果一致性与每周期搬运字节数
+ *   pio test -e native -f test_flush -v
+ *
+ * 基准测的是 hal_native 的帧缓冲区写入, 用于比较两条路径的相对开销;
+ * ESP32上的耗时由SPI决定, 请看 /metrics 的 flush 指标
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "config.h"
+#include "hal.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycle"
+static uint64_t benchCounter()
+{
+    return __rdtsc();
+}
+#else
+// 没有周期计数器时退化为纳秒
+#define BENCH_UNIT "ns"
+static uint64_t benchCounter()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#endif
+
+static uint16_t hostPixels[MAX_X * MAX_Y];
+static uint16_t panelPixels[MAX_X * MAX_Y];
+
+void setUp(void)
+{
+    halDisplayInit();
+    halDisplayRotate(1);
+    for (uint32_t i = 0; i < MAX_X * MAX_Y; i++) {
+        hostPixels[i] = (uint16_t)(i * 2654435761u >> 16);
+        panelPixels[i] = (uint16_t)((hostPixels[i] >> 8) | (hostPixels[i] << 8));
+    }
+}
+
+void tearDown(void)
+{
+}
+
+static void test_variants_write_same_framebuffer(void)
+{
+    static uint16_t expected[MAX_X * MAX_Y];
+    uint32_t width, height;
+
+    halDisplayFlushSwap(10, 20, 64, 32, hostPixels);
+    memcpy(expected, halFramebuffer(&width, &height), sizeof(expected));
+
+    halDisplayInit();
+    halDisplayFlushPreswapped(10, 20, 64, 32, panelPixels);
+    TEST_ASSERT_EQUAL_MEMORY(expected, halFramebuffer(&width, &height), sizeof(expected));
+
+    // 帧缓冲区为面板字节序
+    const uint16_t *fb = halFramebuffer(&width, &height);
+    TEST_ASSERT_EQUAL_UINT32(MAX_X, width);
+    TEST_ASSERT_EQUAL_HEX16(panelPixels[0], fb[20 * width + 10]);
+    TEST_ASSERT_EQUAL_HEX16(panelPixels[64 + 1], fb[21 * width + 11]);
+}
+
+typedef struct
+{
+    const char *name;
+    uint32_t w;
+    uint32_t h;
+} BENCH_AREA;
+
+// 整屏 (页面切换) 与典型的脏区域 (一个数值标签, 一根进度条)
+static const BENCH_AREA benchAreas[] = {
+    {"full", MAX_X, MAX_Y},
+    {"label", 60, 20},
+    {"bar", 120, 8},
+};
+
+#define BENCH_BYTES (64u * 1024 * 1024)
+
+static double benchFlush(HAL_FLUSH_FN flush, const uint16_t *pixels, const BENCH_AREA &area)
+{
+    uint32_t bytes = area.w * area.h * sizeof(uint16_t);
+    uint32_t rounds = BENCH_BYTES / bytes;
+
+    flush(0, 0, area.w, area.h, pixels);
+    uint64_t start = benchCounter();
+    for (uint32_t i = 0; i < rounds; i++) {
+        flush(0, 0, area.w, area.h, pixels);
+    }
+    uint64_t elapsed = benchCounter() - start;
+    return (double)rounds * bytes / elapsed;
+}
+
+static void test_benchmark_bytes_per_cycle(void)
+{
+    char message[128];
+
+    for (const auto &area : benchAreas) {
+        double preswapped = benchFlush(halDisplayFlushPreswapped, panelPixels, area);
+        double swap = benchFlush(halDisplayFlushSwap, hostPixels, area);
+
+        snprintf(message, sizeof(message), "%-5s %3ux%-3u preswapped: %.2f B/%s, swap: %.2f B/%s",
+                 area.name, (unsigned)area.w, (unsigned)area.h, preswapped, BENCH_UNIT, swap, BENCH_UNIT);
+        TEST_MESSAGE(message);
+        TEST_ASSERT_TRUE(preswapped > 0 && swap > 0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_variants_write_same_framebuffer);
+    RUN_TEST(test_benchmark_bytes_per_cycle);
+    return UNITY_END();
+}
@@ -0,0 +1,56 @@
+/*
+ * 界面回归: 以 -g 回放 test/replay 的录制数据, 逐帧与提交的参考图像比较
+ *   pio test -e native -f test_golden
+ *
+ * 界面有意修改后重新录制参考图像并提交:
+ *   pio run -e native && .pio/build/native/program -g test/replay/golden -u test/replay/capture.txt test/replay/layout.html
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "native_replay.h"
+
+static char replayDir[256];
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+// 测试程序的工作目录不一定是工程目录, 按本文件的位置找到 test/replay
+static void locateReplayDir(void)
+{
+    const char *slash = strrchr(__FILE__, '/');
+    int len = slash ? (int)(slash - __FILE__) : 1;
+
+    snprintf(replayDir, sizeof(replayDir), "%.*s/../replay", len, slash ? __FILE__ : ".");
+}
+
+static void test_replay_matches_golden(void)
+{
+    char golden[272], capture[272], layout[272], first[288];
+
+    snprintf(golden, sizeof(golden), "%s/golden", replayDir);
+    snprintf(capture, sizeof(capture), "%s/capture.txt", replayDir);
+    snprintf(layout, sizeof(layout), "%s/layout.html", replayDir);
+    snprintf(first, sizeof(first), "%s/frame_0000.png", golden);
+    if (access(first, F_OK) != 0) {
+        TEST_FAIL_MESSAGE("no reference frames in test/replay/golden, record them with -u (see the header of this file)");
+    }
+
+    char *argv[] = {(char *)"test_golden", (char *)"-g", golden, capture, layout};
+    TEST_ASSERT_EQUAL_INT_MESSAGE(0, nativeReplay(5, argv), "frames differ from test/replay/golden, see *.actual.png");
+}
+
+int main(int argc, char **argv)
+{
+    locateReplayDir();
+    UNITY_BEGIN();
+    RUN_TEST(test_replay_matches_golden);
+    return UNITY_END();
+}
@@ -0,0 +1,173 @@
+/*
+ * SSE帧组装、数据解析和页面布局发现
+ *   pio test -e native -f test_parser
+ */
+
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "aida64_parser.h"
+#include "aida64_layout.h"
+
+static AIDA64_STREAM stream;
+
+static const char layoutPage[] =
+    "<html><body>"
+    "<span id=\"Simple1\" style=\"left:0\">CPU Usage 24%</span>"
+    "<span id=\"Simple2\">CPU Temp 40&deg;C</span>"
+    "<span id=\"Simple3\">CPU Clock 3409 MHz</span>"
+    "<span id=\"Simple12\">Local IP 192.168.1.5</span>"
+    "</body></html>";
+
+void setUp(void)
+{
+    aida64StreamReset(stream);
+}
+
+void tearDown(void)
+{
+}
+
+static void feed(const char *text)
+{
+    size_t space;
+    char *writePtr = aida64StreamWritePtr(stream, &space);
+    size_t len = strlen(text);
+
+    TEST_ASSERT_TRUE(len <= space);
+    memcpy(writePtr, text, len);
+    aida64StreamCommit(stream, len);
+}
+
+static void test_stream_skips_headers_and_blank_lines(void)
+{
+    feed("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n\r\ndata: Page0|{|}Simple1|CPU Usage 1%{|}\n\n");
+
+    char *event = aida64StreamNextEvent(stream);
+    TEST_ASSERT_NOT_NULL(event);
+    TEST_ASSERT_EQUAL_STRING("data: Page0|{|}Simple1|CPU Usage 1%{|}", event);
+    TEST_ASSERT_NULL(aida64StreamNextEvent(stream));
+}
+
+static void test_stream_assembles_event_across_reads(void)
+{
+    feed("data: Page0|{|}Simple1|CPU ");
+    TEST_ASSERT_NULL(aida64StreamNextEvent(stream));
+
+    feed("Usage 7%{|}\n\ndata: Page0|{|}Simple1|CPU Usage 8%{|}\n");
+    char *event = aida64StreamNextEvent(stream);
+    TEST_ASSERT_NOT_NULL(event);
+    TEST_ASSERT_EQUAL_STRING("data: Page0|{|}Simple1|CPU Usage 7%{|}", event);
+
+    event = aida64StreamNextEvent(stream);
+    TEST_ASSERT_NOT_NULL(event);
+    TEST_ASSERT_EQUAL_STRING("data: Page0|{|}Simple1|CPU Usage 8%{|}", event);
+    TEST_ASSERT_NULL(aida64StreamNextEvent(stream));
+    TEST_ASSERT_EQUAL(0, stream.length);
+}
+
+static void test_stream_drops_oversized_line(void)
+{
+    size_t space;
+    char *writePtr = aida64StreamWritePtr(stream, &space);
+
+    // 整个缓冲区都是没有换行的数据, 取不出完整的行时丢弃
+    memset(writePtr, 'x', space);
+    aida64StreamCommit(stream, space);
+    TEST_ASSERT_NULL(aida64StreamNextEvent(stream));
+    TEST_ASSERT_EQUAL(0, stream.length);
+
+    feed("data: Page0|{|}Simple1|CPU Usage 9%{|}\n");
+    TEST_ASSERT_NOT_NULL(aida64StreamNextEvent(stream));
+}
+
+static void test_parse_data_items(void)
+{
+    char event[] = "data: Page0|{|}Simple1|CPU Usage 24%{|}Simple12|Local IP 192.168.1.5{|}Simple4|CPU Power -0.5 W{|}";
+    std::vector<AIDA64_DATA> dataList;
+
+    parseAida64Data(event, dataList);
+    TEST_ASSERT_EQUAL(3, dataList.size());
+    TEST_ASSERT_EQUAL_STRING("Simple1", dataList[0].id);
+    TEST_ASSERT_EQUAL_STRING(">CPUUsage24%", dataList[0].val);
+    TEST_ASSERT_EQUAL_STRING("Simple12", dataList[1].id);
+    TEST_ASSERT_EQUAL_STRING(">LocalIP192.168.1.5", dataList[1].val);
+    TEST_ASSERT_EQUAL_STRING("Simple4", dataList[2].id);
+    TEST_ASSERT_EQUAL_STRING(">CPUPower-0.5W", dataList[2].val);
+}
+
+static void test_parse_data_reuses_list(void)
+{
+    char first[] = "data: Page0|{|}Simple1|CPU Usage 1%{|}Simple2|CPU Temp 40°C{|}";
+    char second[] = "data: Page0|{|}Simple1|CPU Usage 2%{|}";
+    std::vector<AIDA64_DATA> dataList;
+
+    parseAida64Data(first, dataList);
+    TEST_ASSERT_EQUAL(2, dataList.size());
+    parseAida64Data(second, dataList);
+    TEST_ASSERT_EQUAL(1, dataList.size());
+    TEST_ASSERT_EQUAL_STRING(">CPUUsage2%", dataList[0].val);
+}
+
+static void test_layout_from_page(void)
+{
+    std::vector<AIDA64_LAYOUT_ITEM> layout;
+
+    parseAida64Layout(layoutPage, layout);
+    TEST_ASSERT_EQUAL(4, layout.size());
+
+    TEST_ASSERT_EQUAL_STRING("Simple1", layout[0].id);
+    TEST_ASSERT_EQUAL_STRING("CPU Usage", layout[0].label);
+    TEST_ASSERT_EQUAL_STRING("CPUUsage", layout[0].prefix);
+    TEST_ASSERT_EQUAL_STRING("%", layout[0].unit);
+    TEST_ASSERT_EQUAL(1, layout[0].numeric);
+
+    // HTML实体解码后的单位
+    TEST_ASSERT_EQUAL_STRING("°C", layout[1].unit);
+    TEST_ASSERT_EQUAL_STRING("MHz", layout[2].unit);
+
+    TEST_ASSERT_EQUAL_STRING("Local IP", layout[3].label);
+    TEST_ASSERT_EQUAL(0, layout[3].numeric);
+}
+
+static void test_layout_page_without_items(void)
+{
+    std::vector<AIDA64_LAYOUT_ITEM> layout;
+
+    parseAida64Layout("<html><body>RemoteSensor</body></html>", layout);
+    TEST_ASSERT_EQUAL(0, layout.size());
+}
+
+static void test_find_value_after_prefix(void)
+{
+    TEST_ASSERT_EQUAL_STRING("24%", findAida64Value(">CPUUsage24%", "CPUUsage"));
+    TEST_ASSERT_EQUAL_STRING("192.168.1.5", findAida64Value(">LocalIP192.168.1.5", "LocalIP"));
+    TEST_ASSERT_EQUAL_STRING("-0.5W", findAida64Value(">CPUPower-0.5W", "CPUPower"));
+}
+
+static void test_layout_hash_tracks_units(void)
+{
+    std::vector<AIDA64_LAYOUT_ITEM> layout;
+
+    parseAida64Layout(layoutPage, layout);
+    uint32_t hash = calcAida64LayoutHash(layout);
+    TEST_ASSERT_EQUAL_UINT32(hash, calcAida64LayoutHash(layout));
+
+    strcpy(layout[2].unit, "GHz");
+    TEST_ASSERT_TRUE(hash != calcAida64LayoutHash(layout));
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_stream_skips_headers_and_blank_lines);
+    RUN_TEST(test_stream_assembles_event_across_reads);
+    RUN_TEST(test_stream_drops_oversized_line);
+    RUN_TEST(test_parse_data_items);
+    RUN_TEST(test_parse_data_reuses_list);
+    RUN_TEST(test_layout_from_page);
+    RUN_TEST(test_layout_page_without_items);
+    RUN_TEST(test_find_value_after_prefix);
+    RUN_TEST(test_layout_hash_tracks_units);
+    return UNITY_END();
+}
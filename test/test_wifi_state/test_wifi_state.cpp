@@ -0,0 +1,251 @@
+/*
+ * WiFi连接状态机: 用假的驱动按事件序列驱动
+ *   pio test -e native -f test_wifi_state
+ */
+
+#include <unity.h>
+#include <string.h>
+#include "wifi_state.h"
+
+// 记录状态机发出的所有驱动调用
+class FakeWifiDriver : public WifiDriver {
+public:
+    WIFI_CACHE stored;          // "NVS"中的缓存
+    WIFI_CACHE current;         // 当前连接的AP和IP
+    bool hasStored;
+    int connects;
+    int fastConnects;
+    int saves;
+    int reconnects;
+    int connected[WIFI_PATH_MAX];
+    uint32_t lastConnectMs;
+    bool offline;
+
+    FakeWifiDriver() : hasStored(false), connects(0), fastConnects(0), saves(0), reconnects(0),
+                       connected{0, 0}, lastConnectMs(0), offline(false) {
+        memset(&stored, 0, sizeof(stored));
+        memset(&current, 0, sizeof(current));
+        memset(current.bssid, 0xAB, sizeof(current.bssid));
+        current.channel = 6;
+        current.ip = 0x6401A8C0;
+        current.gateway = 0x0101A8C0;
+        current.subnet = 0x00FFFFFF;
+        current.dns = 0x0101A8C0;
+    }
+
+    void connect(const WIFI_CACHE *cache) override {
+        connects++;
+        if (cache != NULL) {
+            fastConnects++;
+        }
+    }
+    bool readCache(WIFI_CACHE &cache) override {
+        cache = current;
+        return true;
+    }
+    bool loadCache(WIFI_CACHE &cache) override {
+        cache = stored;
+        return hasStored;
+    }
+    void saveCache(const WIFI_CACHE &cache) override {
+        stored = cache;
+        hasStored = true;
+        saves++;
+    }
+    void setOffline(bool value) override {
+        offline = value;
+    }
+    void onConnected(WIFI_CONNECT_PATH path, uint32_t connect_ms) override {
+        connected[path]++;
+        lastConnectMs = connect_ms;
+    }
+    void onReconnect() override {
+        reconnects++;
+    }
+
+    void storeCurrent() {
+        stored = current;
+        stored.valid = 1;
+        hasStored = true;
+    }
+};
+
+static FakeWifiDriver *driver;
+static WifiStateMachine *machine;
+
+void setUp(void)
+{
+    driver = new FakeWifiDriver();
+    machine = new WifiStateMachine(*driver);
+}
+
+void tearDown(void)
+{
+    delete machine;
+    delete driver;
+}
+
+static void test_first_boot_scans_and_saves_cache(void)
+{
+    machine->start(0);
+    TEST_ASSERT_EQUAL(WIFI_SM_SCAN_CONNECT, machine->getState());
+    TEST_ASSERT_EQUAL_INT(0, driver->fastConnects);
+
+    machine->onEvent(WIFI_SM_ASSOCIATED, 1500);
+    machine->onEvent(WIFI_SM_GOT_IP, 2500);
+    TEST_ASSERT_EQUAL(WIFI_SM_CONNECTED, machine->getState());
+    TEST_ASSERT_EQUAL_INT(1, driver->connected[WIFI_PATH_SCAN]);
+    TEST_ASSERT_EQUAL_UINT32(2500, driver->lastConnectMs);
+    TEST_ASSERT_EQUAL_INT(1, driver->saves);
+    TEST_ASSERT_EQUAL_UINT8(1, driver->stored.valid);
+    TEST_ASSERT_EQUAL_UINT8(6, driver->stored.channel);
+}
+
+static void test_fast_connect_with_cache(void)
+{
+    driver->storeCurrent();
+    machine->start(0);
+    TEST_ASSERT_EQUAL(WIFI_SM_FAST_CONNECT, machine->getState());
+    TEST_ASSERT_EQUAL_INT(1, driver->fastConnects);
+
+    machine->onEvent(WIFI_SM_GOT_IP, 300);
+    TEST_ASSERT_EQUAL(WIFI_SM_CONNECTED, machine->getState());
+    TEST_ASSERT_EQUAL_INT(1, driver->connected[WIFI_PATH_FAST]);
+    TEST_ASSERT_EQUAL_INT(0, driver->saves);
+}
+
+static void test_fast_connect_timeout_falls_back_to_scan(void)
+{
+    driver->storeCurrent();
+    machine->start(0);
+
+    machine->tick(2999);
+    TEST_ASSERT_EQUAL(WIFI_SM_FAST_CONNECT, machine->getState());
+    machine->tick(3000);
+    TEST_ASSERT_EQUAL(WIFI_SM_SCAN_CONNECT, machine->getState());
+    TEST_ASSERT_EQUAL_INT(2, driver->connects);
+    TEST_ASSERT_EQUAL_INT(1, driver->fastConnects);
+
+    // 超时退回扫描不作废缓存, AP回来后仍可快速连接
+    TEST_ASSERT_EQUAL_INT(0, driver->saves);
+}
+
+static void test_fast_connect_disconnect_invalidates_cache(void)
+{
+    driver->storeCurrent();
+    machine->start(0);
+
+    machine->onEvent(WIFI_SM_DISCONNECTED, 800);
+    TEST_ASSERT_EQUAL(WIFI_SM_SCAN_CONNECT, machine->getState());
+    TEST_ASSERT_EQUAL_INT(1, driver->saves);
+    TEST_ASSERT_EQUAL_UINT8(0, driver->stored.valid);
+
+    // AP换了信道: 扫描连接后写入新的缓存
+    driver->current.channel = 11;
+    machine->onEvent(WIFI_SM_GOT_IP, 4000);
+    TEST_ASSERT_EQUAL(WIFI_SM_CONNECTED, machine->getState());
+    TEST_ASSERT_EQUAL_INT(2, driver->saves);
+    TEST_ASSERT_EQUAL_UINT8(1, driver->stored.valid);
+    TEST_ASSERT_EQUAL_UINT8(11, driver->stored.channel);
+}
+
+static void test_scan_timeout_restarts_scan(void)
+{
+    machine->start(0);
+
+    // 扫描连接中的断开不立即重试
+    machine->onEvent(WIFI_SM_DISCONNECTED, 5000);
+    TEST_ASSERT_EQUAL(WIFI_SM_SCAN_CONNECT, machine->getState());
+    TEST_ASSERT_EQUAL_INT(1, driver->connects);
+
+    machine->tick(14999);
+    TEST_ASSERT_EQUAL_INT(1, driver->connects);
+    machine->tick(15000);
+    TEST_ASSERT_EQUAL(WIFI_SM_SCAN_CONNECT, machine->getState());
+    TEST_ASSERT_EQUAL_INT(2, driver->connects);
+    TEST_ASSERT_EQUAL_INT(1, driver->reconnects);
+
+    machine->tick(30000);
+    TEST_ASSERT_EQUAL_INT(3, driver->connects);
+    TEST_ASSERT_EQUAL_INT(0, driver->fastConnects);
+}
+
+static void test_connected_disconnect_reconnects_fast(void)
+{
+    driver->storeCurrent();
+    machine->start(0);
+    machine->onEvent(WIFI_SM_GOT_IP, 300);
+
+    machine->onEvent(WIFI_SM_DISCONNECTED, 10000);
+    TEST_ASSERT_EQUAL(WIFI_SM_FAST_CONNECT, machine->getState());
+    TEST_ASSERT_EQUAL_INT(2, driver->fastConnects);
+    TEST_ASSERT_EQUAL_INT(1, driver->reconnects);
+
+    // 连接耗时从断开时刻算起
+    machine->onEvent(WIFI_SM_GOT_IP, 10400);
+    TEST_ASSERT_EQUAL_UINT32(400, driver->lastConnectMs);
+}
+
+static void test_offline_after_timeout(void)
+{
+    machine->start(0);
+
+    machine->tick(59999);
+    TEST_ASSERT_FALSE(driver->offline);
+    machine->tick(60000);
+    TEST_ASSERT_TRUE(driver->offline);
+
+    machine->onEvent(WIFI_SM_GOT_IP, 61000);
+    TEST_ASSERT_FALSE(driver->offline);
+}
+
+static void test_got_ip_ignored_when_not_connecting(void)
+{
+    machine->onEvent(WIFI_SM_GOT_IP, 100);
+    TEST_ASSERT_EQUAL(WIFI_SM_IDLE, machine->getState());
+    TEST_ASSERT_EQUAL_INT(0, driver->connected[WIFI_PATH_FAST] + driver->connected[WIFI_PATH_SCAN]);
+}
+
+// wifi_client.cpp 按原因码过滤驱动事件, ASSOC_LEAVE 不送入状态机
+static void test_assoc_leave_is_not_failure(void)
+{
+    TEST_ASSERT_FALSE(wifiDisconnectIsFailure(WIFI_SM_REASON_ASSOC_LEAVE));
+    TEST_ASSERT_TRUE(wifiDisconnectIsFailure(2));      // AUTH_EXPIRE
+    TEST_ASSERT_TRUE(wifiDisconnectIsFailure(15));     // 4WAY_HANDSHAKE_TIMEOUT
+    TEST_ASSERT_TRUE(wifiDisconnectIsFailure(201));    // NO_AP_FOUND
+}
+
+// 快速连接超时退回扫描时, 重新配置产生的 ASSOC_LEAVE 不应再作废缓存
+static void test_assoc_leave_during_fallback_keeps_cache(void)
+{
+    const uint8_t reasons[] = {WIFI_SM_REASON_ASSOC_LEAVE};
+
+    driver->storeCurrent();
+    machine->start(0);
+    machine->tick(3000);
+
+    for (uint8_t reason : reasons) {
+        if (wifiDisconnectIsFailure(reason)) {
+            machine->onEvent(WIFI_SM_DISCONNECTED, 3010);
+        }
+    }
+    TEST_ASSERT_EQUAL(WIFI_SM_SCAN_CONNECT, machine->getState());
+    TEST_ASSERT_EQUAL_INT(0, driver->saves);
+    TEST_ASSERT_EQUAL_UINT8(1, driver->stored.valid);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_boot_scans_and_saves_cache);
+    RUN_TEST(test_fast_connect_with_cache);
+    RUN_TEST(test_fast_connect_timeout_falls_back_to_scan);
+    RUN_TEST(test_fast_connect_disconnect_invalidates_cache);
+    RUN_TEST(test_scan_timeout_restarts_scan);
+    RUN_TEST(test_connected_disconnect_reconnects_fast);
+    RUN_TEST(test_offline_after_timeout);
+    RUN_TEST(test_got_ip_ignored_when_not_connecting);
+    RUN_TEST(test_assoc_leave_is_not_failure);
+    RUN_TEST(test_assoc_leave_during_fallback_keeps_cache);
+    return UNITY_END();
+}
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+比较两个提交的 env:native 基准结果 (program -b), 用于在提交说明中给出修改前后的数据
+
+每个提交检出到临时的git worktree中, 用 pio run -e native 构建, 以同一份录制数据运行 -b,
+再按每次更新的输出行 (frame dispatch_us render_us flush_us areas pixels) 计算平均值和最大值.
+只解析逐行输出, 没有汇总功能的旧提交也可以比较. 第一次更新绘制整个屏幕, 不计入
+
+用法:
+    python3 tools/bench_compare.py be8a0b9^ be8a0b9
+    python3 tools/bench_compare.py [--runs N] <修改前> <修改后> [capture.txt] [layout.html]
+
+默认使用当前工作区的 test/replay/capture.txt 和 layout.html; include/config.h 从当前工作区复制,
+不存在时使用 config.example.h. 耗时取 N 次运行 (默认5) 中各列平均值的中位数, 区域数和像素数与运行次数无关
+"""
+
+import argparse
+import os
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+
+COLUMNS = ["dispatch_us", "render_us", "flush_us", "areas", "pixels"]
+
+
+def run(cmd, cwd):
+    result = subprocess.run(cmd, cwd=cwd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, text=True)
+    if result.returncode != 0:
+        sys.stdout.write(result.stdout)
+        sys.exit("%s failed in %s" % (" ".join(cmd), cwd))
+    return result.stdout
+
+
+def parse_rows(output):
+    rows = []
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == len(COLUMNS) + 1 and all(f.isdigit() for f in fields):
+            rows.append([int(f) for f in fields[1:]])
+    return rows[1:]
+
+
+def bench(repo, rev, capture, layout, runs, workdir):
+    tree = os.path.join(workdir, "tree_%d" % len(os.listdir(workdir)))
+    run(["git", "worktree", "add", "--detach", tree, rev], repo)
+    try:
+        config = os.path.join(repo, "include", "config.h")
+        if not os.path.exists(config):
+            config = os.path.join(repo, "include", "config.example.h")
+        shutil.copy(config, os.path.join(tree, "include", "config.h"))
+
+        run(["pio", "run", "-e", "native"], tree)
+        program = os.path.join(tree, ".pio", "build", "native", "program")
+
+        averages = []
+        maxima = [0] * len(COLUMNS)
+        for _ in range(runs):
+            rows = parse_rows(run([program, "-b", capture, layout], tree))
+            if not rows:
+                sys.exit("%s: no benchmark rows in the output" % rev)
+            averages.append([sum(col) / len(rows) for col in zip(*rows)])
+            maxima = [max(m, max(col)) for m, col in zip(maxima, zip(*rows))]
+        return [statistics.median(col) for col in zip(*averages)], maxima, len(rows)
+    finally:
+        run(["git", "worktree", "remove", "--force", tree], repo)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="compare native -b results of two revisions")
+    parser.add_argument("--runs", type=int, default=5)
+    parser.add_argument("before")
+    parser.add_argument("after")
+    parser.add_argument("capture", nargs="?", default="test/replay/capture.txt")
+    parser.add_argument("layout", nargs="?", default="test/replay/layout.html")
+    args = parser.parse_args()
+
+    repo = run(["git", "rev-parse", "--show-toplevel"], os.getcwd()).strip()
+    capture = os.path.abspath(args.capture)
+    layout = os.path.abspath(args.layout)
+
+    with tempfile.TemporaryDirectory() as workdir:
+        before_avg, before_max, updates = bench(repo, args.before, capture, layout, args.runs, workdir)
+        after_avg, after_max, _ = bench(repo, args.after, capture, layout, args.runs, workdir)
+
+    print("%d updates, median of %d runs" % (updates, args.runs))
+    print("%-12s %12s %12s %8s %12s %12s" % ("per update", "before avg", "after avg", "change", "before max", "after max"))
+    for i, name in enumerate(COLUMNS):
+        change = (after_avg[i] - before_avg[i]) * 100 / before_avg[i] if before_avg[i] else 0
+        print("%-12s %12.0f %12.0f %7.1f%% %12d %12d" % (name, before_avg[i], after_avg[i], change,
+                                                          before_max[i], after_max[i]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+"""
+构建前生成只包含界面实际绘制字形的LVGL字体, 代替完整的Montserrat
+
+字符集 = 可打印ASCII (标签、单位和数值来自AIDA64, 运行时才知道)
+       + 界面相关源文件中字符串常量和格式模板里出现的非ASCII字符 (例如 °)
+       + 源文件中用到的 LV_SYMBOL_*
+字号取自 lv_conf.h 中的 LV_FONT_DEFAULT (lv_font_montserrat_N)
+
+作为PlatformIO的 pre: 脚本运行 (见 platformio.ini 的 extra_scripts):
+  - 字符集或字号变化时用 lv_font_conv 重新生成 src/fonts/aida64_font_N.c
+  - 生成成功后定义 AIDA64_FONT_SUBSET, lv_conf.h 据此切换默认字体
+  - 找不到 lv_font_conv (npm i -g lv_font_conv) 或字体文件时给出警告, 继续使用完整的Montserrat
+
+也可以单独运行, 只打印字符集和大小对比:
+    python3 tools/font_subset.py [--lvgl <lvgl库目录>]
+"""
+
+import hashlib
+import os
+import re
+import shutil
+import subprocess
+import sys
+
+# 界面绘制的文本来自这些文件
+UI_SOURCES = [
+    "src/display.cpp",
+    "src/fixed_format.cpp",
+    "src/aida64_layout.cpp",
+    "src/aida64_parser.cpp",
+]
+
+FONT_DIR = "src/fonts"
+FONT_BPP = 4
+ASCII_RANGE = (0x20, 0x7E)
+
+# 作为这些函数参数的字符串只用于匹配, 不会显示
+MATCH_CALL = re.compile(r"\b(?:strstr|strcmp|strncmp|strcasecmp|strncasecmp|containsNoCase)\([^()]*$")
+
+
+def c_literals(text):
+    """返回源代码中可能显示的字符串常量 (跳过注释、字符常量和字符串比较的参数)"""
+    literals = []
+    i = 0
+    while i < len(text):
+        c = text[i]
+        if text.startswith("//", i):
+            i = text.find("\n", i)
+            if i < 0:
+                break
+        elif text.startswith("/*", i):
+            i = text.find("*/", i)
+            if i < 0:
+                break
+            i += 2
+        elif c == "'":
+            i += 1
+            while i < len(text) and text[i] != "'":
+                i += 2 if text[i] == "\\" else 1
+            i += 1
+        elif c == '"':
+            i += 1
+            start = i
+            while i < len(text) and text[i] != '"':
+                i += 2 if text[i] == "\\" else 1
+            if not MATCH_CALL.search(text[max(0, start - 80):start - 1]):
+                literals.append(unescape(text[start:i]))
+            i += 1
+        else:
+            i += 1
+    return literals
+
+
+def unescape(literal):
+    # 源文件为UTF-8, 十六进制转义按字节处理后再统一解码
+    out = bytearray()
+    i = 0
+    raw = literal.encode("utf-8")
+    simple = {ord("n"): b"\n", ord("r"): b"\r", ord("t"): b"\t", ord("\\"): b"\\", ord('"'): b'"', ord("'"): b"'", ord("0"): b"\0"}
+    while i < len(raw):
+        if raw[i] == ord("\\") and i + 1 < len(raw):
+            nxt = raw[i + 1]
+            if nxt == ord("x"):
+                m = re.match(rb"[0-9a-fA-F]{1,2}", raw[i + 2:])
+                if m:
+                    out.append(int(m.group(0), 16))
+                    i += 2 + len(m.group(0))
+                    continue
+            out += simple.get(nxt, bytes([nxt]))
+            i += 2
+        else:
+            out.append(raw[i])
+            i += 1
+    return out.decode("utf-8", errors="ignore")
+
+
+def strip_format(literal):
+    # printf转换说明本身不会显示, 输出的数字和符号已包含在ASCII范围内
+    return re.sub(r"%[-+ #0]*\d*(?:\.\d+)?(?:hh|h|ll|l|z)?[diouxXfFeEgGcsp%]", "", literal)
+
+
+def symbol_codepoints(lvgl_dir, names):
+    """LV_SYMBOL_xxx -> Unicode码点, 取自 lv_symbol_def.h"""
+    path = os.path.join(lvgl_dir, "src", "font", "lv_symbol_def.h")
+    codepoints = {}
+    if not os.path.isfile(path):
+        return codepoints
+    with open(path, encoding="utf-8") as f:
+        for m in re.finditer(r"#define\s+LV_SYMBOL_(\w+)\s+\"((?:\\x[0-9A-Fa-f]{2})+)\"", f.read()):
+            if m.group(1) in names:
+                codepoints[m.group(1)] = ord(unescape(m.group(2)))
+    return codepoints
+
+
+def collect(project_dir, lvgl_dir):
+    chars = set(chr(c) for c in range(ASCII_RANGE[0], ASCII_RANGE[1] + 1))
+    symbols = set()
+
+    for rel in UI_SOURCES:
+        path = os.path.join(project_dir, rel)
+        if not os.path.isfile(path):
+            continue
+        with open(path, encoding="utf-8") as f:
+            text = f.read()
+        for literal in c_literals(text):
+            chars.update(ch for ch in strip_format(literal) if ord(ch) > 0x7E)
+        symbols.update(re.findall(r"\bLV_SYMBOL_(\w+)", text))
+
+    extra = sorted(ch for ch in chars if ord(ch) > 0x7E)
+    codepoints = sorted(symbol_codepoints(lvgl_dir, symbols).values()) if lvgl_dir else []
+    return extra, codepoints, sorted(symbols)
+
+
+def default_font_size(project_dir):
+    with open(os.path.join(project_dir, "lv_conf.h"), encoding="utf-8") as f:
+        m = re.search(r"#define\s+LV_FONT_DEFAULT\s+&lv_font_montserrat_(\d+)", f.read())
+    return int(m.group(1)) if m else 14
+
+
+def font_stats(path):
+    """(字形数, 位图字节数), 按lv_font_conv生成的C文件统计"""
+    if not os.path.isfile(path):
+        return None
+    with open(path, encoding="utf-8", errors="ignore") as f:
+        text = f.read()
+    bitmap = re.search(r"glyph_bitmap\[\]\s*=\s*\{(.*?)\};", text, re.S)
+    glyphs = len(re.findall(r"\.bitmap_index\s*=", text))
+    size = len(re.findall(r"0x[0-9a-fA-F]{2}", bitmap.group(1))) if bitmap else 0
+    # 第一个字形描述符是保留的空字形
+    return max(glyphs - 1, 0), size
+
+
+def stamp(size, extra, codepoints):
+    key = "%d|%d|%s|%s" % (size, FONT_BPP, "".join(extra), ",".join("%x" % c for c in codepoints))
+    return hashlib.sha1(key.encode("utf-8")).hexdigest()[:12]
+
+
+def read_stamp(path):
+    if not os.path.isfile(path):
+        return None
+    with open(path, encoding="utf-8", errors="ignore") as f:
+        m = re.match(r"/\* font_subset (\w+) \*/", f.readline())
+    return m.group(1) if m else None
+
+
+def find_converter():
+    exe = shutil.which("lv_font_conv")
+    if exe:
+        return [exe]
+    if shutil.which("npx"):
+        try:
+            subprocess.run(["npx", "--no-install", "lv_font_conv", "--help"], check=True,
+                           stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+            return ["npx", "--no-install", "lv_font_conv"]
+        except (OSError, subprocess.CalledProcessError):
+            pass
+    return None
+
+
+def generate(converter, lvgl_dir, out, size, extra, codepoints):
+    fonts = os.path.join(lvgl_dir, "scripts", "built_in_font")
+    text_font = os.path.join(fonts, "Montserrat-Medium.ttf")
+    symbol_font = os.path.join(fonts, "FontAwesome5-Solid+Brands+Regular.woff")
+    if not os.path.isfile(text_font):
+        raise RuntimeError("%s not found" % text_font)
+
+    name = os.path.splitext(os.path.basename(out))[0]
+    cmd = converter + ["--font", text_font, "--range", "0x%X-0x%X" % ASCII_RANGE]
+    if extra:
+        cmd += ["--symbols", "".join(extra)]
+    if codepoints:
+        cmd += ["--font", symbol_font, "--range", ",".join("0x%X" % c for c in codepoints)]
+    cmd += ["--size", str(size), "--bpp", str(FONT_BPP), "--format", "lvgl", "--no-compress",
+            "--lv-include", "lvgl.h", "--lv-font-name", name, "-o", out]
+    subprocess.run(cmd, check=True)
+
+    with open(out, encoding="utf-8") as f:
+        body = f.read()
+    with open(out, "w", encoding="utf-8") as f:
+        f.write("/* font_subset %s */\n" % stamp(size, extra, codepoints))
+        f.write("/* 由 tools/font_subset.py 生成, 不要手工修改 */\n")
+        f.write(body)
+
+
+def report(lvgl_dir, out, size, extra, codepoints, symbols):
+    print("[font] size %d: ASCII 0x%02X-0x%02X + %s + %d symbols%s" % (
+        size, ASCII_RANGE[0], ASCII_RANGE[1], "".join(extra) or "(none)", len(codepoints),
+        (" (" + ", ".join(symbols) + ")") if symbols else ""))
+
+    before = font_stats(os.path.join(lvgl_dir, "src", "font", "lv_font_montserrat_%d.c" % size)) if lvgl_dir else None
+    after = font_stats(out)
+    if before:
+        print("[font] before: lv_font_montserrat_%d  %4d glyphs, bitmap %6d bytes" % (size, before[0], before[1]))
+    if after:
+        print("[font] after:  %-22s %4d glyphs, bitmap %6d bytes" % (os.path.basename(out)[:-2], after[0], after[1]))
+    if before and after:
+        print("[font] saved %d bytes of glyph bitmaps" % (before[1] - after[1]))
+
+
+def run(project_dir, lvgl_dir, build=True):
+    size = default_font_size(project_dir)
+    extra, codepoints, symbols = collect(project_dir, lvgl_dir)
+    out = os.path.join(project_dir, FONT_DIR, "aida64_font_%d.c" % size)
+    current = stamp(size, extra, codepoints)
+
+    if build and read_stamp(out) != current:
+        converter = find_converter()
+        if converter is None or lvgl_dir is None:
+            print("[font] warning: lv_font_conv or the LVGL sources not found, using the full Montserrat font")
+            return False
+        os.makedirs(os.path.dirname(out), exist_ok=True)
+        try:
+            generate(converter, lvgl_dir, out, size, extra, codepoints)
+        except (OSError, RuntimeError, subprocess.CalledProcessError) as e:
+            print("[font] warning: %s, using the full Montserrat font" % e)
+            if os.path.isfile(out):
+                os.remove(out)
+            return False
+
+    report(lvgl_dir, out, size, extra, codepoints, symbols)
+    return read_stamp(out) == current
+
+
+def pio_main(env):
+    project_dir = env.subst("$PROJECT_DIR")
+    lvgl_dir = os.path.join(env.subst("$PROJECT_LIBDEPS_DIR"), env.subst("$PIOENV"), "lvgl")
+    if not os.path.isdir(lvgl_dir):
+        # 首次构建时库还没有下载, 本次使用完整字体
+        lvgl_dir = None
+    if run(project_dir, lvgl_dir):
+        env.Append(CPPDEFINES=["AIDA64_FONT_SUBSET"])
+
+
+if __name__ == "__main__":
+    lvgl = None
+    if "--lvgl" in sys.argv:
+        lvgl = sys.argv[sys.argv.index("--lvgl") + 1]
+    run(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), lvgl, build=False)
+else:
+    Import("env")  # noqa: F821 (PlatformIO SCons环境)
+    pio_main(env)  # noqa: F821
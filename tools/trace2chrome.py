@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""
+将设备导出的跟踪缓冲区转换为Chrome trace JSON, 可在 https://ui.perfetto.dev 或 chrome://tracing 打开
+
+用法:
+    curl -o trace.bin http://<设备IP>:9100/trace
+    python3 tools/trace2chrome.py trace.bin > trace.json
+
+也可以直接读取串口日志 (在串口发送 't' 后保存的输出), 只解析 "TRACE:" 开头的行:
+    python3 tools/trace2chrome.py serial.log > trace.json
+"""
+
+import json
+import struct
+import sys
+
+TRACE_MAGIC = 0x43525441
+HEADER = struct.Struct("<IHHIHH")
+TASK = struct.Struct("<I16s")
+NAME = struct.Struct("<16s")
+EVENT = struct.Struct("<IIBBBB")
+
+
+def load(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if data[:4] == struct.pack("<I", TRACE_MAGIC):
+        return data
+
+    # 串口日志: 拼接 TRACE:BEGIN 与 TRACE:END 之间的十六进制行, 多次导出时取最后一次
+    dumps = []
+    for raw in data.decode("utf-8", "replace").splitlines():
+        line = raw.strip()
+        if not line.startswith("TRACE:"):
+            continue
+        payload = line[6:]
+        if payload == "BEGIN":
+            dumps.append(bytearray())
+        elif payload == "END":
+            continue
+        elif dumps:
+            dumps[-1] += bytes.fromhex(payload)
+    if not dumps:
+        sys.exit("no trace dump found in %s" % path)
+    return bytes(dumps[-1])
+
+
+def cstr(raw):
+    return raw.split(b"\0", 1)[0].decode("ascii", "replace")
+
+
+def convert(data):
+    magic, version, event_size, count, task_count, name_count = HEADER.unpack_from(data, 0)
+    if magic != TRACE_MAGIC or version != 1 or event_size != EVENT.size:
+        sys.exit("unsupported trace dump (magic %08x version %d event size %d)" % (magic, version, event_size))
+
+    offset = HEADER.size
+    tasks = {}
+    for _ in range(task_count):
+        handle, name = TASK.unpack_from(data, offset)
+        tasks[handle] = cstr(name)
+        offset += TASK.size
+
+    names = []
+    for _ in range(name_count):
+        names.append(cstr(NAME.unpack_from(data, offset)[0]))
+        offset += NAME.size
+
+    events = []
+    tids = {}
+    base = None
+    last = 0
+    wraps = 0
+    for _ in range(count):
+        time_us, task, trace_id, trace_type, core, _reserved = EVENT.unpack_from(data, offset)
+        offset += EVENT.size
+
+        # 32位微秒时间戳约71分钟回绕一次
+        if base is not None and time_us < last and last - time_us > 0x80000000:
+            wraps += 1
+        last = time_us
+        ts = time_us + (wraps << 32)
+        if base is None:
+            base = ts
+
+        tid = tids.setdefault(task, len(tids) + 1)
+        events.append({
+            "name": names[trace_id] if trace_id < len(names) else "id%d" % trace_id,
+            "ph": "B" if trace_type == 0 else "E",
+            "ts": ts - base,
+            "pid": 1,
+            "tid": tid,
+            "args": {"core": core},
+        })
+
+    events.append({"name": "process_name", "ph": "M", "pid": 1, "args": {"name": "aida64-esp32"}})
+    for task, tid in tids.items():
+        events.append({"name": "thread_name", "ph": "M", "pid": 1, "tid": tid,
+                       "args": {"name": tasks.get(task, "task %08x" % task)}})
+
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: trace2chrome.py <trace.bin | serial.log>")
+    json.dump(convert(load(sys.argv[1])), sys.stdout, indent=1)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()